@@ -2,13 +2,14 @@
 #include <complex>
 #include <vector>
 #include <cmath>
+#include <string>
+#include "fft.h"
+#include "fft_real.h"
+#include "fft_io.h"
 
 using namespace std;
 
-typedef complex<double> Complex;
-const double PI = acos(-1);
-
-// Recursive Cooley-Tukey FFT
+// Recursive Cooley-Tukey FFT (N must be a power of two; FftPlan handles any N)
 void fft(vector<Complex> &a) {
     int N = a.size();
     if (N <= 1) return;
@@ -32,7 +33,48 @@ void fft(vector<Complex> &a) {
     }
 }
 
-int main() {
+// Command-line mode: FFT of a signal file (see fft_io.h) into another.
+// ./Cooley_Tukey [-p float|double|long] [-l interleaved|split] [-i] input|synth:N output
+// -p is the precision of the transform and of the output (default double),
+// -i the inverse (unnormalized) transform.
+int run_tool(int argc, char** argv) {
+    uint32_t precision = sizeof(double);
+    SignalLayout layout = SIGNAL_INTERLEAVED;
+    FftDirection dir = FFT_FORWARD;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-p" && i + 1 < argc) precision = parse_precision(argv[++i]);
+        else if (arg == "-l" && i + 1 < argc) layout = parse_layout(argv[++i]);
+        else if (arg == "-i") dir = FFT_BACKWARD;
+        else paths.push_back(arg);
+    }
+    if (paths.size() != 2) {
+        cerr << "Usage: " << argv[0] << " [-p float|double|long] [-l interleaved|split] [-i] input|synth:N output" << endl;
+        return 1;
+    }
+
+    double seconds;
+    if (precision == sizeof(float)) seconds = fft_file<float>(paths[0], paths[1], layout, dir);
+    else if (precision == sizeof(double)) seconds = fft_file<double>(paths[0], paths[1], layout, dir);
+    else seconds = fft_file<long double>(paths[0], paths[1], layout, dir);
+
+    size_t N = MappedSignal::open(paths[1]).size();
+    cout << "N = " << N << " (" << real_bytes_name(precision) << ") -> " << paths[1] << endl;
+    cout << "FFT time: " << seconds << " s, " << 5.0 * N * log2((double)N) / seconds * 1e-9 << " GFLOP/s" << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        try {
+            return run_tool(argc, argv);
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
     int N = 8;
     vector<Complex> x(N);
 
@@ -44,10 +86,35 @@ int main() {
     cout << "Input:\n";
     for (auto val : x) cout << val << endl;
 
-    fft(x);
+    // Setup once: the plan owns the twiddles and bit-reversal indices
+    FftPlan plan(N, FFT_FORWARD);
+
+    vector<Complex> x_rec = x;
+    fft(x_rec);
+    plan.execute(x, x);
 
     cout << "\nFFT Output:\n";
     for (auto val : x) cout << val << endl;
 
+    // Check the iterative engine against the recursive version
+    double max_diff = 0;
+    for (int i = 0; i < N; i++) {
+        max_diff = max(max_diff, abs(x[i] - x_rec[i]));
+    }
+    cout << "\nMax difference vs recursive fft: " << max_diff << endl;
+
+    // The input is real, so the r2c transform gives the same N/2+1
+    // non-redundant bins from an N/2-point complex FFT
+    vector<double> x_real(N);
+    for (int i = 0; i < N; i++) {
+        x_real[i] = sin(2 * PI * i / N);
+    }
+    RealFftPlan real_plan(N);
+    vector<Complex> X_half;
+    real_plan.r2c(x_real, X_half);
+
+    cout << "\nReal-input FFT Output (bins 0.." << N/2 << "):\n";
+    for (auto val : X_half) cout << val << endl;
+
     return 0;
 }
\ No newline at end of file
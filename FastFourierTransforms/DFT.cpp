@@ -2,29 +2,11 @@
 #include <complex>
 #include <vector>
 #include <cmath>
+#include "dft.h"
+#include "czt.h"
 
 using namespace std;
 
-typedef complex<double> Complex;
-const double PI = acos(-1);
-
-// Direct DFT: X[k] = sum_{n=0}^{N-1} x[n] * exp(-2πikn/N)
-vector<Complex> dft(const vector<Complex> &x) {
-    int N = x.size();
-    vector<Complex> X(N);
-
-    for (int k = 0; k < N; ++k) {
-        Complex sum = 0;
-        for (int n = 0; n < N; ++n) {
-            double angle = -2 * PI * k * n / N;
-            sum += x[n] * Complex(cos(angle), sin(angle));
-        }
-        X[k] = sum;
-    }
-
-    return X;
-}
-
 int main() {
     int N = 8;
     vector<Complex> x(N);
@@ -42,5 +24,32 @@ int main() {
     cout << "\nDFT Output:\n";
     for (auto val : X) cout << val << endl;
 
+    // Zoom: a 10000-point DFT has bins 1e-4 cycles/sample apart; 1000
+    // chirp-z points over a 0.004-wide band sample it every 4e-6, which
+    // locates the two tones without zero-padding (Hann window to keep the
+    // sidelobes down)
+    int Nz = 10000, M = 1000;
+    double f_lo = 0.198, f_hi = 0.202;
+    vector<Complex> y(Nz);
+    for (int n = 0; n < Nz; n++) {
+        double w = 0.5 - 0.5 * cos(2 * PI * n / Nz);
+        y[n] = w * (cos(2 * PI * 0.1998 * n) + 0.5 * cos(2 * PI * 0.2003 * n));
+    }
+    ChirpZPlan zoom = zoom_fft_plan(Nz, M, f_lo, f_hi);
+    vector<Complex> Z;
+    zoom.execute(y, Z);
+
+    cout << "\nChirp-z zoom of [" << f_lo << ", " << f_hi << ") with " << M << " points"
+         << " (convolution FFT of " << zoom.fft_size() << "; plain zero-padding to this"
+         << " resolution needs a " << llround(M / (f_hi - f_lo)) << "-point FFT)\n";
+    cout << "Local maxima above 10% of the largest:\n";
+    double top = 0;
+    for (auto val : Z) top = max(top, abs(val));
+    for (int k = 1; k + 1 < M; k++) {
+        if (abs(Z[k]) > 0.1 * top && abs(Z[k]) >= abs(Z[k - 1]) && abs(Z[k]) >= abs(Z[k + 1])) {
+            cout << "f = " << zoom.frequency(k) << "  |X| = " << abs(Z[k]) << endl;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
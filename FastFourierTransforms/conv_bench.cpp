@@ -0,0 +1,104 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <random>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "fft_conv.h"
+
+using namespace std;
+
+// Real convolution of n random samples with random kernels of each length:
+// the direct plan (CONV_DIRECT, one thread), the automatic plan on one long
+// channel and on CHANNELS channels (both with -t threads), and fft_convolve().
+// Every result is checked against the direct one (max |error| / max |y|).
+// Usage: ./conv_bench [-t threads] [-n samples] [taps ...]
+//        (default: 2^20 samples, 16 256 1024 4096 taps)
+
+const size_t CHANNELS = 4;
+const double TOLERANCE = 1e-10;
+
+// Seconds per call, repeating until at least 0.2 s has elapsed
+template <typename F>
+double time_it(F f) {
+    int reps = 0;
+    double seconds = 0;
+    auto start = chrono::steady_clock::now();
+    while (seconds < 0.2) {
+        f();
+        ++reps;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    return seconds / reps;
+}
+
+double relative_error(const double* y, const vector<double>& ref) {
+    double err = 0, norm = 0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        err = max(err, fabs(y[i] - ref[i]));
+        norm = max(norm, fabs(ref[i]));
+    }
+    return norm > 0 ? err / norm : err;
+}
+
+int main(int argc, char** argv) {
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    size_t n = 1 << 20;
+    vector<size_t> taps;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "-n" && i + 1 < argc) n = atol(argv[++i]);
+        else taps.push_back(atol(argv[i]));
+    }
+    if (taps.empty()) taps = {16, 256, 1024, 4096};
+
+    mt19937 rng(12345);
+    uniform_real_distribution<double> u(-1, 1);
+    vector<double> x(n * CHANNELS);
+    for (double& v : x) v = u(rng);
+    vector<double> x0(x.begin(), x.begin() + n);
+
+    cout << n << " samples, " << threads << " thread(s)" << endl;
+    cout << setw(7) << "taps" << setw(9) << "method" << setw(7) << "block" << setw(13) << "direct (ms)"
+         << setw(11) << "auto (ms)" << setw(15) << "batch (ms/ch)" << setw(19) << "fft_convolve (ms)"
+         << setw(12) << "max error" << setw(8) << "check" << endl;
+    for (size_t M : taps) {
+        vector<double> h(M);
+        for (double& v : h) v = u(rng);
+        ConvolutionPlan direct(h, CONV_DIRECT), fast(h, CONV_AUTO, threads, n);
+        size_t ny = direct.output_size(n);
+
+        // References: the direct sum for channel 0 and for every batch channel
+        vector<double> ref(ny), ys(ny * CHANNELS), y1, y2;
+        double t_direct = time_it([&] { direct.convolve(x0, ref); });
+        vector<vector<double> > refs(CHANNELS);
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            refs[c].resize(ny);
+            direct.convolve(x.data() + c * n, n, refs[c].data());
+        }
+
+        double t_auto = time_it([&] { fast.convolve(x0, y1); });
+        double t_batch = time_it([&] { fast.convolve_batch(x.data(), n, CHANNELS, ys.data()); });
+        double t_once = time_it([&] { y2 = fft_convolve(x0, h, threads); });
+
+        double err = max(relative_error(y1.data(), ref), relative_error(y2.data(), ref));
+        for (size_t c = 0; c < CHANNELS; ++c) err = max(err, relative_error(ys.data() + c * ny, refs[c]));
+        bool ok = y1.size() == ny && y2.size() == ny && err < TOLERANCE;
+
+        cout << setw(7) << M << setw(9) << (fast.method() == CONV_FFT ? "fft" : "direct") << setw(7)
+             << fast.block_size() << setw(13) << t_direct * 1e3 << setw(11) << t_auto * 1e3 << setw(15)
+             << t_batch / CHANNELS * 1e3 << setw(19) << t_once * 1e3 << setw(12) << err << setw(8)
+             << (ok ? "ok" : "WRONG") << endl;
+    }
+
+    return 0;
+}
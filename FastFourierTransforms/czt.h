@@ -0,0 +1,116 @@
+#ifndef CZT_H
+#define CZT_H
+
+#include "fft.h"
+
+// Chirp-z transform: the z-transform of x[0..N) at M points on a spiral arc
+//     z_k = r0 * rstep^k * exp(2πi (f0 + k*df)),   k = 0 .. M-1
+//     X[k] = sum_n x[n] z_k^(-n)
+// With r0 = rstep = 1 this is the DTFT at frequencies f0, f0+df, ... in
+// cycles/sample (multiply by the sample rate for Hz), so a narrow band can
+// be resolved as finely as wanted without zero-padding to a huge FFT; with
+// f0 = 0, df = 1/N, M = N it is the ordinary DFT.
+//
+// Bluestein's identity nk = (n² + k² - (k-n)²)/2 with W = z_k / z_(k+1) gives
+//     X[k] = W^(k²/2) sum_n (x[n] z_0^(-n) W^(n²/2)) W^(-(k-n)²/2)
+// a linear convolution of length N+M-1, done with one power-of-two FftPlan
+// of length L >= N+M-1: two transforms per execute(), the kernel's
+// spectrum precomputed, so the cost is O((N+M) log(N+M)).
+//
+// Chirp phases grow like n², so they are reduced in long double turns
+// before the sine/cosine. Off the unit circle (r0, rstep != 1) the chirp
+// magnitudes grow like rstep^(n²/2), which limits spirals to modest N and M.
+class ChirpZPlan {
+public:
+    ChirpZPlan(std::size_t N, std::size_t M, double f0, double df, int threads = 1,
+               double r0 = 1, double rstep = 1)
+        : N_(N), M_(M), f0_(f0), df_(df), plan_(conv_size(N, M), FFT_FORWARD, threads) {
+        if (r0 <= 0 || rstep <= 0) throw std::invalid_argument("ChirpZPlan: radii must be positive");
+        std::size_t L = plan_.size();
+        // W = rstep^-1 exp(-2πi df); W^t for t = m²/2
+        long double log_w = -std::log((long double)rstep), w_turns = -(long double)df;
+        long double log_a = std::log((long double)r0), a_turns = (long double)f0;
+
+        pre_.resize(N);
+        for (std::size_t n = 0; n < N; ++n) {
+            long double t = half_square(n);
+            // z_0^(-n) W^(n²/2)
+            pre_[n] = power(-log_a * n + log_w * t, -a_turns * n + w_turns * t);
+        }
+        post_.resize(M);
+        for (std::size_t k = 0; k < M; ++k) post_[k] = power(log_w * half_square(k), w_turns * half_square(k));
+
+        // Kernel W^(-m²/2) for m = -(N-1) .. M-1, wrapped for circular convolution
+        kernel_fft_.assign(L, Complex(0));
+        for (std::size_t m = 0; m < M; ++m) kernel_fft_[m] = power(-log_w * half_square(m), -w_turns * half_square(m));
+        for (std::size_t m = 1; m < N; ++m) {
+            kernel_fft_[L - m] = power(-log_w * half_square(m), -w_turns * half_square(m));
+        }
+        plan_.execute(kernel_fft_.data(), kernel_fft_.data());
+        work_.resize(L);
+        scratch_.resize(plan_.scratch_size());
+    }
+
+    std::size_t size() const { return N_; }
+    std::size_t points() const { return M_; }
+    // Length of the internal convolution FFT
+    std::size_t fft_size() const { return plan_.size(); }
+    // Frequency of output k in cycles/sample (on the unit circle)
+    double frequency(std::size_t k) const { return f0_ + k * df_; }
+
+    // out[0..M) = X[0..M) for in[0..N)
+    void execute(const Complex* in, Complex* out) const {
+        std::size_t L = plan_.size();
+        Complex* y = work_.data();
+        for (std::size_t n = 0; n < N_; ++n) y[n] = in[n] * pre_[n];
+        std::fill(y + N_, y + L, Complex(0));
+        plan_.execute(y, y, scratch_.data());
+        // Pointwise product, then inverse FFT as conj(FFT(conj(.)))/L
+        for (std::size_t k = 0; k < L; ++k) y[k] = std::conj(y[k] * kernel_fft_[k]);
+        plan_.execute(y, y, scratch_.data());
+        double scale = 1.0 / L;
+        for (std::size_t k = 0; k < M_; ++k) out[k] = std::conj(y[k]) * scale * post_[k];
+    }
+
+    void execute(const std::vector<Complex>& in, std::vector<Complex>& out) const {
+        if (in.size() != N_) throw std::invalid_argument("ChirpZPlan::execute: input size does not match plan");
+        out.resize(M_);
+        execute(in.data(), out.data());
+    }
+
+private:
+    // Checked here since it runs in the initializer list, before plan_ is built
+    static std::size_t conv_size(std::size_t N, std::size_t M) {
+        if (N == 0 || M == 0) throw std::invalid_argument("ChirpZPlan: N and M must be positive");
+        std::size_t L = 1;
+        while (L < N + M - 1) L <<= 1;
+        return L;
+    }
+
+    // m²/2, exact in long double for m < 2^31
+    static long double half_square(std::size_t m) {
+        return (long double)((unsigned long long)m * m) / 2;
+    }
+
+    // exp(log_mag) * exp(2πi turns), with turns reduced to [0, 1) first
+    static Complex power(long double log_mag, long double turns) {
+        const long double two_pi = 6.283185307179586476925286766559005768L;
+        turns -= std::floor(turns);
+        long double mag = std::exp(log_mag);
+        return Complex((double)(mag * std::cos(two_pi * turns)), (double)(mag * std::sin(two_pi * turns)));
+    }
+
+    std::size_t N_, M_;
+    double f0_, df_;
+    FftPlan plan_;
+    AlignedComplexVector pre_, post_, kernel_fft_;
+    mutable AlignedComplexVector work_, scratch_;
+};
+
+// Zoom FFT: M points covering the band [f_lo, f_hi) of the DTFT of N samples
+// (cycles/sample), i.e. a resolution of (f_hi - f_lo)/M instead of 1/N
+inline ChirpZPlan zoom_fft_plan(std::size_t N, std::size_t M, double f_lo, double f_hi, int threads = 1) {
+    return ChirpZPlan(N, M, f_lo, (f_hi - f_lo) / M, threads);
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef DFT_H
+#define DFT_H
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include "fft.h"
+
+// Direct DFT: X[k] = sum_{n=0}^{N-1} x[n] * exp(-2πikn/N)
+// O(N²); used as the reference ("oracle") the FFT variants are checked against.
+inline std::vector<Complex> dft(const std::vector<Complex> &x) {
+    int N = x.size();
+    std::vector<Complex> X(N);
+
+    for (int k = 0; k < N; ++k) {
+        Complex sum = 0;
+        for (int n = 0; n < N; ++n) {
+            double angle = -2 * PI * k * n / N;
+            sum += x[n] * Complex(cos(angle), sin(angle));
+        }
+        X[k] = sum;
+    }
+
+    return X;
+}
+
+#endif
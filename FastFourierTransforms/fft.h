@@ -0,0 +1,597 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "fft_codelets.h"
+
+typedef std::complex<double> Complex;
+const double PI = std::acos(-1);
+
+// Allocator returning 64-byte aligned storage (one cache line, one AVX-512 register)
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        void* p = nullptr;
+        if (posix_memalign(&p, Alignment, n * sizeof(T) + (n == 0)) != 0) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, std::size_t) { std::free(p); }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template <typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T> >;
+
+typedef AlignedVector<Complex> AlignedComplexVector;
+
+// Scalar type used to compute twiddles for a plan of type Real: float plans
+// get their tables from double sin/cos and long double plans from long double,
+// so the tables are never less accurate than the data they are applied to
+template <typename Real>
+struct TwiddleCalc {
+    typedef typename std::conditional<(sizeof(Real) > sizeof(double)), Real, double>::type type;
+};
+
+// exp(sign * 2πi * num/den) in Real precision, computed in TwiddleCalc precision
+template <typename Real>
+inline std::complex<Real> unit_root(int sign, unsigned long long num, unsigned long long den) {
+    typedef typename TwiddleCalc<Real>::type C;
+    const C pi = std::acos(C(-1));
+    C angle = sign * 2 * pi * C(num) / C(den);
+    return std::complex<Real>(Real(std::cos(angle)), Real(std::sin(angle)));
+}
+
+// Twiddle table: tw[k] = exp(-2πik/N) for k < N/2
+// Every radix-2 stage of length len reads tw[j * (N/len)], so one table
+// built at setup time serves all log2(N) stages.
+inline std::vector<Complex> make_twiddles(std::size_t N) {
+    std::vector<Complex> tw(N / 2);
+    for (std::size_t k = 0; k < N / 2; ++k) {
+        tw[k] = std::polar(1.0, -2 * PI * k / N);
+    }
+    return tw;
+}
+
+// Bit-reversal permutation: rev[i] is i with its log2(N) bits reversed
+inline std::vector<std::size_t> make_bitrev(std::size_t N) {
+    std::vector<std::size_t> rev(N, 0);
+    int bits = 0;
+    while ((std::size_t(1) << bits) < N) ++bits;
+    for (std::size_t i = 0; i < N; ++i) {
+        std::size_t r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (std::size_t(1) << b)) r |= std::size_t(1) << (bits - 1 - b);
+        }
+        rev[i] = r;
+    }
+    return rev;
+}
+
+// log2(N) radix-2 butterfly stages on bit-reversed data, in place.
+// tw[k] must hold the k-th power of a primitive N-th root of unity for at
+// least k < N/2. C is any ring element type with +, - and *: std::complex
+// for the FFT, a modular integer for the number-theoretic transform (ntt.h).
+template <typename C>
+inline void butterfly_stages(C* a, std::size_t N, const C* tw, int threads = 1) {
+    if (threads <= 1) {
+        for (std::size_t len = 2; len <= N; len <<= 1) {
+            std::size_t half = len / 2;
+            std::size_t stride = N / len;
+            for (std::size_t start = 0; start < N; start += len) {
+                for (std::size_t j = 0; j < half; ++j) {
+                    C t = tw[j * stride] * a[start + j + half];
+                    C u = a[start + j];
+                    a[start + j] = u + t;
+                    a[start + j + half] = u - t;
+                }
+            }
+        }
+        return;
+    }
+
+    #pragma omp parallel num_threads(threads)
+    for (std::size_t len = 2; len <= N; len <<= 1) {
+        std::size_t half = len / 2;
+        std::size_t stride = N / len;
+        // Flatten (block, j) into one butterfly index so every stage has N/2
+        // independent iterations to share, however few blocks it has
+        long long butterflies = (long long)(N / 2);
+        #pragma omp for schedule(static)
+        for (long long b = 0; b < butterflies; ++b) {
+            std::size_t j = (std::size_t)b & (half - 1);
+            std::size_t start = ((std::size_t)b - j) * 2;
+            C t = tw[j * stride] * a[start + j + half];
+            C u = a[start + j];
+            a[start + j] = u + t;
+            a[start + j + half] = u - t;
+        }
+    }
+}
+
+// Complex radix-2 stages: tw[k] = exp(±2πik/N) for k < N/2
+template <typename Real>
+inline void fft_radix2_stages(std::complex<Real>* a, std::size_t N, const std::complex<Real>* tw,
+                              int threads = 1) {
+    butterfly_stages(a, N, tw, threads);
+}
+
+// Iterative in-place radix-2 Cooley-Tukey FFT (N must be a power of two)
+// Same result as the recursive fft(), but with no allocation and no sin/cos
+// per call: tw and rev come from make_twiddles(N) and make_bitrev(N).
+inline void fft_iterative(std::vector<Complex>& a, const std::vector<Complex>& tw,
+                          const std::vector<std::size_t>& rev) {
+    std::size_t N = a.size();
+    if (N <= 1) return;
+
+    // Reorder input so each butterfly stage works on contiguous blocks
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+    }
+
+    fft_radix2_stages(a.data(), N, tw.data());
+}
+
+// Sign of the exponent: forward uses exp(-2πikn/N), backward exp(+2πikn/N)
+// The backward transform is unnormalized, so backward(forward(x)) = N * x.
+enum FftDirection { FFT_FORWARD = -1, FFT_BACKWARD = 1 };
+
+// Radix-4 butterfly in place; j = dir * i
+template <typename Real>
+inline void dft4(std::complex<Real>* a, int dir) {
+    typedef std::complex<Real> C;
+    C t0 = a[0] + a[2], t1 = a[0] - a[2];
+    C t2 = a[1] + a[3], t3 = a[1] - a[3];
+    C jt3(-dir * t3.imag(), dir * t3.real());
+    a[0] = t0 + t2;
+    a[1] = t1 + jt3;
+    a[2] = t0 - t2;
+    a[3] = t1 - jt3;
+}
+
+// Odd prime radix (3, 5, 7) butterfly in place using symmetric pairs:
+// b_k = a_0 + sum_r (a_r + a_{P-r}) cos(2πrk/P) + i*dir * sum_r (a_r - a_{P-r}) sin(2πrk/P)
+// and b_{P-k} is the same with the sine term negated.
+// c[m] = cos(2πm/P), s[m] = dir * sin(2πm/P)
+template <int P, typename Real>
+inline void dft_odd(std::complex<Real>* a, const Real* c, const Real* s) {
+    typedef std::complex<Real> C;
+    const int H = (P - 1) / 2;
+    C t[H + 1], u[H + 1];
+    C b0 = a[0];
+    for (int r = 1; r <= H; ++r) {
+        t[r] = a[r] + a[P - r];
+        u[r] = a[r] - a[P - r];
+        b0 += t[r];
+    }
+    C out[P];
+    out[0] = b0;
+    for (int k = 1; k <= H; ++k) {
+        C A = a[0], B = 0;
+        for (int r = 1; r <= H; ++r) {
+            int m = (r * k) % P;
+            A += t[r] * c[m];
+            B += u[r] * s[m];
+        }
+        C iB(-B.imag(), B.real());
+        out[k] = A + iB;
+        out[P - k] = A - iB;
+    }
+    for (int k = 0; k < P; ++k) a[k] = out[k];
+}
+
+// One radix-P Stockham butterfly: gathers x[s0 + s*(q + m*r)], r < P,
+// applies the radix-P DFT and the twiddles, and writes y[s0 + s*(P*q + k)]
+template <int P, typename Real>
+inline void stockham_butterfly(const std::complex<Real>* x, std::complex<Real>* y, long long m, long long s,
+                               long long q, long long s0, const std::complex<Real>* tw, int dir,
+                               const Real* c, const Real* sn) {
+    std::complex<Real> a[P];
+    for (int r = 0; r < P; ++r) a[r] = x[s0 + s * (q + m * r)];
+    if (P == 2) {
+        std::complex<Real> t = a[0];
+        a[0] = t + a[1];
+        a[1] = t - a[1];
+    } else if (P == 4) {
+        dft4(a, dir);
+    } else {
+        dft_odd<P>(a, c, sn);
+    }
+    y[s0 + s * P * q] = a[0];
+    for (int k = 1; k < P; ++k) {
+        y[s0 + s * (P * q + k)] = a[k] * tw[(std::size_t)(q * k * s)];
+    }
+}
+
+// One self-sorting Stockham (decimation in frequency) stage of radix P.
+// x holds N/s interleaved sub-transforms of length n = N/s; after the stage y
+// holds N/(s*P) of length n/P, already in natural order, so no bit-reversal
+// pass is needed. tw is the plan's table of N roots: exp(dir*2πiqk/n) = tw[q*k*s].
+template <int P, typename Real>
+inline void stockham_stage(const std::complex<Real>* x, std::complex<Real>* y, std::size_t N, std::size_t s,
+                           const std::complex<Real>* tw, int dir, const Real* c, const Real* sn,
+                           int threads) {
+    long long m = (long long)(N / (s * P));
+    long long ss = (long long)s;
+    // An if() clause would still open a serialized region per stage, which
+    // dominates small transforms, so only enter OpenMP when it can help
+    if (threads <= 1) {
+        for (long long q = 0; q < m; ++q) {
+            for (long long s0 = 0; s0 < ss; ++s0) {
+                stockham_butterfly<P, Real>(x, y, m, ss, q, s0, tw, dir, c, sn);
+            }
+        }
+        return;
+    }
+    #pragma omp parallel for collapse(2) schedule(static) num_threads(threads)
+    for (long long q = 0; q < m; ++q) {
+        for (long long s0 = 0; s0 < ss; ++s0) {
+            stockham_butterfly<P, Real>(x, y, m, ss, q, s0, tw, dir, c, sn);
+        }
+    }
+}
+
+// Serial leaf of the recursive FFT: iterative radix-2 FFT of in[0], in[s],
+// ... into out[0..N). The first log2(B) stages are B-point codelets, one per
+// block of out; block j transforms the residue class bitrev(j) of the input,
+// so no separate permutation pass is needed. Without a codelet (B == 1) the
+// strided input is gathered straight into bit-reversed order. tw is the root
+// table of the top-level size, so the twiddle exp(dir*2πik/len) at this
+// level is tw[k * (N/len) * s].
+template <typename Real>
+inline void fft_strided_leaf(const std::complex<Real>* in, std::complex<Real>* out, std::size_t N,
+                             std::size_t s, const std::complex<Real>* tw, int dir) {
+    typedef std::complex<Real> C;
+    std::size_t B = std::min(N, FFT_CODELET_MAX);
+    typename CodeletFn<Real>::type codelet = find_codelet<Real>(B, dir);
+    if (!codelet) B = 1;
+    std::size_t blocks = N / B;
+    std::size_t r = 0;
+    for (std::size_t j = 0; j < blocks; ++j) {
+        if (codelet) codelet(in + r * s, blocks * s, out + j * B);
+        else out[j] = in[r * s];
+        // Increment r in bit-reversed order (over log2(blocks) bits)
+        std::size_t bit = blocks >> 1;
+        while (bit && (r & bit)) {
+            r ^= bit;
+            bit >>= 1;
+        }
+        r |= bit;
+    }
+    for (std::size_t len = 2 * B; len <= N; len <<= 1) {
+        std::size_t half = len / 2;
+        std::size_t step = (N / len) * s;
+        for (std::size_t start = 0; start < N; start += len) {
+            for (std::size_t j = 0; j < half; ++j) {
+                C t = tw[j * step] * out[start + j + half];
+                C u = out[start + j];
+                out[start + j] = u + t;
+                out[start + j + half] = u - t;
+            }
+        }
+    }
+}
+
+// Recursive (cache-oblivious) radix-2 Cooley-Tukey FFT, out of place
+// out[0..N) = FFT of in[0], in[s], in[2s], ... (N a power of two). The even
+// half lands in out[0..N/2) and the odd half in out[N/2..N), then they are
+// combined in place, so nothing is allocated. Below `leaf` points the serial
+// iterative leaf, built on codelets, takes over. With tasks = true the
+// halves and the combine loop become OpenMP tasks; call it from inside a
+// parallel/single region.
+template <typename Real>
+inline void fft_recursive(const std::complex<Real>* in, std::complex<Real>* out, std::size_t N,
+                          std::size_t s, const std::complex<Real>* tw, int dir, std::size_t leaf, bool tasks) {
+    if (N <= leaf) {
+        fft_strided_leaf(in, out, N, s, tw, dir);
+        return;
+    }
+    std::size_t half = N / 2;
+
+    // Conquer: one task per half
+    #pragma omp task if(tasks)
+    fft_recursive(in, out, half, 2 * s, tw, dir, leaf, tasks);
+    #pragma omp task if(tasks)
+    fft_recursive(in + s, out + half, half, 2 * s, tw, dir, leaf, tasks);
+    #pragma omp taskwait
+
+    // Combine
+    std::size_t grain = leaf / 2 ? leaf / 2 : 1;
+    (void)grain;
+    #pragma omp taskloop if(tasks) grainsize(grain)
+    for (std::size_t k = 0; k < half; ++k) {
+        std::complex<Real> t = tw[k * s] * out[k + half];
+        out[k + half] = out[k] - t;
+        out[k] = out[k] + t;
+    }
+}
+
+// Algorithm choices for a plan. FFT_AUTO picks by N (see FftPlanT);
+// the others force a variant, which the auto-tuner uses to time candidates.
+enum FftAlgorithm { FFT_AUTO, FFT_RADIX2, FFT_STOCKHAM, FFT_BLUESTEIN, FFT_RECURSIVE, FFT_CODELET };
+
+struct FftVariant {
+    FftAlgorithm algorithm;
+    int radix;           // FFT_STOCKHAM: 4 uses radix-4 stages where possible, 2 only radix-2
+    std::size_t leaf;    // FFT_RECURSIVE: sub-transform size handled by the serial leaf
+
+    FftVariant(FftAlgorithm a = FFT_AUTO, int r = 4, std::size_t l = 1024)
+        : algorithm(a), radix(r), leaf(l) {}
+};
+
+// FFTW-style plan: build once for a size, direction and thread count, then
+// call execute() for every frame of that length. All setup (twiddles,
+// permutation indices, scratch, Bluestein chirp) happens in the constructor;
+// execute() does only the butterflies.
+//
+// Any N is supported:
+//  - powers of two up to FFT_CODELET_MAX run a straight-line codelet
+//    (fft_codelets.h)
+//  - larger powers of two use the radix-2 engine: codelets for the first
+//    log2(FFT_CODELET_MAX) stages, then iterative butterflies
+//  - other N whose prime factors are all 2, 3, 5 or 7 use mixed-radix
+//    Stockham stages with radix-2/3/4/5/7 kernels
+//  - anything else (primes > 7, or sizes with such a factor) uses
+//    Bluestein's chirp-z algorithm over a power-of-two convolution
+// A FftVariant overrides this choice: power-of-two sizes can also run as
+// Stockham stages or as the task-parallel recursive FFT.
+//
+// Templated on the scalar type: FftPlanT<float>, FftPlanT<double> and
+// FftPlanT<long double> are built from the same source; FftPlan is the
+// double-precision plan used throughout.
+template <typename Real>
+class FftPlanT {
+public:
+    typedef Real real_type;
+    typedef std::complex<Real> complex_type;
+
+    typedef FftAlgorithm Algorithm;
+
+    FftPlanT(std::size_t N, FftDirection dir = FFT_FORWARD, int threads = 1,
+             const FftVariant& variant = FftVariant())
+        : N_(N), dir_(dir), threads_(threads < 1 ? 1 : threads), variant_(variant), tw_(N) {
+        if (N == 0) throw std::invalid_argument("FftPlanT: N must be positive");
+
+        // Full table of N roots so callers (e.g. the direct DFT) can index any k*n mod N
+        for (std::size_t k = 0; k < N; ++k) {
+            tw_[k] = unit_root<Real>(dir, k, N);
+        }
+
+        for (int p = 0; p < 8; ++p) {
+            for (int m = 0; m < 8; ++m) {
+                std::complex<Real> w = unit_root<Real>(dir, m, p ? p : 1);
+                cos_[p][m] = w.real();
+                sin_[p][m] = w.imag();   // = dir * sin(2πm/p)
+            }
+        }
+
+        bool pow2 = (N & (N - 1)) == 0;
+        FftAlgorithm a = variant.algorithm;
+        if (a == FFT_RECURSIVE && !pow2) a = FFT_AUTO;
+        if (a == FFT_RADIX2 && !pow2) a = FFT_AUTO;
+        if (a == FFT_CODELET && !find_codelet<Real>(N, dir)) a = FFT_AUTO;
+        if (a == FFT_STOCKHAM && !factorize(N, variant.radix)) a = FFT_AUTO;
+        if (a == FFT_AUTO) {
+            if (pow2 && N <= FFT_CODELET_MAX) a = FFT_CODELET;
+            else if (pow2) a = FFT_RADIX2;
+            else if (factorize(N, variant.radix)) a = FFT_STOCKHAM;
+            else a = FFT_BLUESTEIN;
+        }
+        algo_ = variant_.algorithm = a;
+
+        switch (algo_) {
+        case FFT_RADIX2: rev_ = make_bitrev(N); scratch_.resize(N); break;
+        case FFT_STOCKHAM: scratch_.resize(N); break;
+        case FFT_RECURSIVE: scratch_.resize(N); break;
+        case FFT_CODELET: codelet_ = find_codelet<Real>(N, dir); scratch_.resize(N); break;
+        default: init_bluestein(); break;
+        }
+    }
+
+    std::size_t size() const { return N_; }
+    FftDirection direction() const { return dir_; }
+    int threads() const { return threads_; }
+    Algorithm algorithm() const { return algo_; }
+    const FftVariant& variant() const { return variant_; }
+    const std::vector<int>& factors() const { return factors_; }
+
+    // exp(dir * 2πik/N), k taken mod N
+    const complex_type& root(std::size_t k) const { return tw_[k % N_]; }
+    const complex_type* roots() const { return tw_.data(); }
+
+    // Number of complex_type elements execute() needs as work space
+    std::size_t scratch_size() const { return scratch_.size(); }
+
+    // out = FFT(in); in == out transforms in place, otherwise the arrays must not overlap.
+    // Uses the plan's own scratch, so one plan must not execute on two threads at once.
+    void execute(const complex_type* in, complex_type* out) const {
+        execute(in, out, scratch_.data());
+    }
+
+    // Same, with caller-provided scratch of scratch_size() elements, so several
+    // threads can share one plan (and its twiddles) with a buffer each
+    void execute(const complex_type* in, complex_type* out, complex_type* scratch) const {
+        int t = N_ >= 4096 ? threads_ : 1;
+        switch (algo_) {
+        case FFT_RADIX2:
+            if (t <= 1) {
+                // Serial: codelets for the first stages, reading in[] while
+                // writing out[], so in-place calls go via scratch
+                if (in == out) {
+                    std::copy(in, in + N_, scratch);
+                    in = scratch;
+                }
+                fft_strided_leaf(in, out, N_, 1, tw_.data(), (int)dir_);
+                break;
+            }
+            if (in == out) {
+                for (std::size_t i = 0; i < N_; ++i) {
+                    if (i < rev_[i]) std::swap(out[i], out[rev_[i]]);
+                }
+            } else {
+                for (std::size_t i = 0; i < N_; ++i) out[rev_[i]] = in[i];
+            }
+            fft_radix2_stages(out, N_, tw_.data(), t);
+            break;
+        case FFT_STOCKHAM:
+            execute_stockham(in, out, scratch, t);
+            break;
+        case FFT_RECURSIVE:
+            execute_recursive(in, out, scratch, t);
+            break;
+        case FFT_CODELET:
+            // Codelets read in[] while writing out[], so in-place calls go via scratch
+            if (in == out) {
+                std::copy(in, in + N_, scratch);
+                in = scratch;
+            }
+            codelet_(in, 1, out);
+            break;
+        default:
+            execute_bluestein(in, out, scratch);
+            break;
+        }
+    }
+
+    void execute(const std::vector<complex_type>& in, std::vector<complex_type>& out) const {
+        if (in.size() != N_) throw std::invalid_argument("FftPlanT::execute: input size does not match plan");
+        out.resize(N_);
+        execute(in.data(), out.data());
+    }
+
+private:
+    // Split N into radices 4 (if max_radix >= 4), 2, 3, 5, 7; false if another prime remains
+    bool factorize(std::size_t N, int max_radix) {
+        factors_.clear();
+        std::size_t n = N;
+        while (max_radix >= 4 && n % 4 == 0) { factors_.push_back(4); n /= 4; }
+        while (n % 2 == 0) { factors_.push_back(2); n /= 2; }
+        for (int p = 3; p <= 7; p += 2) {
+            while (n % p == 0) { factors_.push_back(p); n /= p; }
+        }
+        if (n != 1) factors_.clear();
+        return n == 1;
+    }
+
+    void execute_stockham(const complex_type* in, complex_type* out, complex_type* scratch, int t) const {
+        std::size_t stages = factors_.size();
+        if (stages == 0) {
+            // N == 1
+            out[0] = in[0];
+            return;
+        }
+        const complex_type* src = in;
+        // Ping-pong between out and scratch so that the last stage lands in out
+        if (in == out && stages % 2 == 1) {
+            std::copy(in, in + N_, scratch);
+            src = scratch;
+        }
+        std::size_t s = 1;
+        for (std::size_t k = 0; k < stages; ++k) {
+            complex_type* dst = ((stages - 1 - k) % 2 == 0) ? out : scratch;
+            int p = factors_[k];
+            switch (p) {
+            case 2: stockham_stage<2>(src, dst, N_, s, tw_.data(), dir_, cos_[2], sin_[2], t); break;
+            case 3: stockham_stage<3>(src, dst, N_, s, tw_.data(), dir_, cos_[3], sin_[3], t); break;
+            case 4: stockham_stage<4>(src, dst, N_, s, tw_.data(), dir_, cos_[4], sin_[4], t); break;
+            case 5: stockham_stage<5>(src, dst, N_, s, tw_.data(), dir_, cos_[5], sin_[5], t); break;
+            case 7: stockham_stage<7>(src, dst, N_, s, tw_.data(), dir_, cos_[7], sin_[7], t); break;
+            }
+            s *= p;
+            src = dst;
+        }
+    }
+
+    void execute_recursive(const complex_type* in, complex_type* out, complex_type* scratch, int t) const {
+        // The recursion reads in[] while writing out[], so in-place calls go via scratch
+        if (in == out) {
+            std::copy(in, in + N_, scratch);
+            in = scratch;
+        }
+        std::size_t leaf = variant_.leaf ? variant_.leaf : 1;
+        if (t <= 1) {
+            fft_recursive(in, out, N_, 1, tw_.data(), (int)dir_, leaf, false);
+            return;
+        }
+        #pragma omp parallel num_threads(t)
+        #pragma omp single
+        fft_recursive(in, out, N_, 1, tw_.data(), (int)dir_, leaf, true);
+    }
+
+    // Bluestein: nk = (n² + k² - (k-n)²)/2, so
+    // X_k = c_k * sum_n (x_n c_n) conj(c_{k-n}) with chirp c_n = exp(dir*πi n²/N),
+    // a linear convolution evaluated with a power-of-two FFT of length M >= 2N-1.
+    void init_bluestein() {
+        std::size_t M = 1;
+        while (M < 2 * N_ - 1) M <<= 1;
+        sub_.reset(new FftPlanT(M, FFT_FORWARD, threads_));
+        chirp_.resize(N_);
+        for (std::size_t n = 0; n < N_; ++n) {
+            // n² mod 2N keeps the angle small and accurate for large n
+            // exp(dir*πi n²/N) = exp(dir*2πi (n² mod 2N) / 2N)
+            unsigned long long n2 = ((unsigned long long)n * n) % (2 * N_);
+            chirp_[n] = unit_root<Real>(dir_, n2, 2 * N_);
+        }
+        // Spectrum of the conjugate chirp kernel, wrapped for circular convolution
+        chirp_fft_.assign(M, complex_type(0));
+        chirp_fft_[0] = std::conj(chirp_[0]);
+        for (std::size_t n = 1; n < N_; ++n) {
+            chirp_fft_[n] = chirp_fft_[M - n] = std::conj(chirp_[n]);
+        }
+        sub_->execute(chirp_fft_.data(), chirp_fft_.data());
+        // M for the convolution, then the sub-plan's own work space
+        scratch_.resize(M + sub_->scratch_size());
+    }
+
+    void execute_bluestein(const complex_type* in, complex_type* out, complex_type* scratch) const {
+        std::size_t M = sub_->size();
+        complex_type* sub_scratch = scratch + M;
+        for (std::size_t n = 0; n < N_; ++n) scratch[n] = in[n] * chirp_[n];
+        std::fill(scratch + N_, scratch + M, complex_type(0));
+        sub_->execute(scratch, scratch, sub_scratch);
+        // Pointwise product, then inverse FFT as conj(FFT(conj(.)))/M
+        for (std::size_t k = 0; k < M; ++k) scratch[k] = std::conj(scratch[k] * chirp_fft_[k]);
+        sub_->execute(scratch, scratch, sub_scratch);
+        Real scale = Real(1) / M;
+        for (std::size_t k = 0; k < N_; ++k) out[k] = std::conj(scratch[k]) * scale * chirp_[k];
+    }
+
+    std::size_t N_;
+    FftDirection dir_;
+    int threads_;
+    FftVariant variant_;
+    Algorithm algo_;
+    AlignedVector<complex_type> tw_;
+    std::vector<std::size_t> rev_;
+    std::vector<int> factors_;
+    Real cos_[8][8], sin_[8][8];
+    typename CodeletFn<Real>::type codelet_ = 0;
+    mutable AlignedVector<complex_type> scratch_;
+    std::unique_ptr<FftPlanT> sub_;
+    AlignedVector<complex_type> chirp_, chirp_fft_;
+};
+
+typedef FftPlanT<float> FftPlanF;
+typedef FftPlanT<double> FftPlan;
+typedef FftPlanT<long double> FftPlanL;
+
+#endif
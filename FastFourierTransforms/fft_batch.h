@@ -0,0 +1,138 @@
+#ifndef FFT_BATCH_H
+#define FFT_BATCH_H
+
+#include "fft.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Batched FFT: howmany independent signals of length N sharing one plan.
+// Signal b, element j lives at data[b*dist + j*stride] (FFTW "advanced"
+// layout), so contiguous batches (stride 1, dist N) and interleaved
+// channels (stride = channels, dist 1) are both covered. Output uses the
+// same layout.
+//
+// The batch is split across OpenMP threads. For power-of-two N above the
+// codelet sizes (fft_codelets.h) and up to BATCH_LANES_MAX_N,
+// BATCH_LANES signals are transposed into split real/imag buffers
+// [element][signal] and transformed together: each butterfly applies one
+// twiddle to BATCH_LANES adjacent values, which the compiler turns into
+// full-width vector operations. Other N run one signal at a time through
+// the shared FftPlan. All buffers are allocated per thread at plan time.
+const std::size_t BATCH_LANES = 8;
+const std::size_t BATCH_LANES_MAX_N = 1024;
+
+class BatchFftPlan {
+public:
+    BatchFftPlan(std::size_t N, std::size_t howmany, FftDirection dir = FFT_FORWARD, int threads = 1,
+                 std::size_t stride = 1, std::size_t dist = 0)
+        : N_(N), howmany_(howmany), stride_(stride), dist_(dist ? dist : N * stride),
+          threads_(threads < 1 ? 1 : threads), plan_(N, dir, 1) {
+        lanes_ = plan_.algorithm() == FFT_RADIX2 && N <= BATCH_LANES_MAX_N && howmany > 1;
+        if (lanes_) {
+            rev_ = make_bitrev(N);
+            // Stage twiddles stored contiguously: wr/wi[half + j] = exp(dir*2πij/(2*half))
+            wr_.resize(N);
+            wi_.resize(N);
+            for (std::size_t half = 1; half < N; half <<= 1) {
+                for (std::size_t j = 0; j < half; ++j) {
+                    Complex w = std::polar(1.0, dir * PI * j / half);
+                    wr_[half + j] = w.real();
+                    wi_[half + j] = w.imag();
+                }
+            }
+            work_size_ = 2 * N * BATCH_LANES;
+        } else {
+            work_size_ = 2 * (N + plan_.scratch_size());
+        }
+        work_.resize(threads_ * work_size_);
+    }
+
+    std::size_t size() const { return N_; }
+    std::size_t howmany() const { return howmany_; }
+    bool vectorized_across_signals() const { return lanes_; }
+
+    void execute(const Complex* in, Complex* out) const {
+        std::size_t groups = lanes_ ? (howmany_ + BATCH_LANES - 1) / BATCH_LANES : howmany_;
+        #pragma omp parallel for schedule(static) num_threads(threads_) if(threads_ > 1)
+        for (long long g = 0; g < (long long)groups; ++g) {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            double* work = work_.data() + tid * work_size_;
+            if (lanes_) {
+                execute_lanes(in, out, (std::size_t)g * BATCH_LANES, work);
+            } else {
+                execute_one(in, out, (std::size_t)g, reinterpret_cast<Complex*>(work));
+            }
+        }
+    }
+
+private:
+    void execute_one(const Complex* in, Complex* out, std::size_t b, Complex* work) const {
+        const Complex* src = in + b * dist_;
+        Complex* dst = out + b * dist_;
+        if (stride_ == 1) {
+            plan_.execute(src, dst, work);
+            return;
+        }
+        for (std::size_t j = 0; j < N_; ++j) work[j] = src[j * stride_];
+        plan_.execute(work, work, work + N_);
+        for (std::size_t j = 0; j < N_; ++j) dst[j * stride_] = work[j];
+    }
+
+    // Radix-2 FFT of signals b0 .. b0+BATCH_LANES-1 at once (missing tail lanes are zero)
+    void execute_lanes(const Complex* in, Complex* out, std::size_t b0, double* work) const {
+        const std::size_t L = BATCH_LANES;
+        std::size_t count = std::min(L, howmany_ - b0);
+        double* re = work;
+        double* im = work + N_ * L;
+
+        // Gather in bit-reversed order, transposing to [element][lane]
+        for (std::size_t w = 0; w < count; ++w) {
+            const Complex* src = in + (b0 + w) * dist_;
+            for (std::size_t j = 0; j < N_; ++j) {
+                re[rev_[j] * L + w] = src[j * stride_].real();
+                im[rev_[j] * L + w] = src[j * stride_].imag();
+            }
+        }
+        for (std::size_t w = count; w < L; ++w) {
+            for (std::size_t j = 0; j < N_; ++j) re[j * L + w] = im[j * L + w] = 0;
+        }
+
+        for (std::size_t half = 1; half < N_; half <<= 1) {
+            for (std::size_t start = 0; start < N_; start += 2 * half) {
+                for (std::size_t j = 0; j < half; ++j) {
+                    double cr = wr_[half + j], ci = wi_[half + j];
+                    double* ar = re + (start + j) * L;        double* ai = im + (start + j) * L;
+                    double* br = re + (start + j + half) * L; double* bi = im + (start + j + half) * L;
+                    #pragma omp simd
+                    for (std::size_t w = 0; w < L; ++w) {
+                        double tr = cr * br[w] - ci * bi[w];
+                        double ti = cr * bi[w] + ci * br[w];
+                        br[w] = ar[w] - tr; bi[w] = ai[w] - ti;
+                        ar[w] += tr;        ai[w] += ti;
+                    }
+                }
+            }
+        }
+
+        for (std::size_t w = 0; w < count; ++w) {
+            Complex* dst = out + (b0 + w) * dist_;
+            for (std::size_t j = 0; j < N_; ++j) dst[j * stride_] = Complex(re[j * L + w], im[j * L + w]);
+        }
+    }
+
+    std::size_t N_, howmany_, stride_, dist_;
+    int threads_;
+    FftPlan plan_;
+    bool lanes_;
+    std::vector<std::size_t> rev_;
+    std::vector<double, AlignedAllocator<double> > wr_, wi_;
+    std::size_t work_size_;
+    mutable std::vector<double, AlignedAllocator<double> > work_;
+};
+
+#endif
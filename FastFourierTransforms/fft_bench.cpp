@@ -0,0 +1,164 @@
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "fft.h"
+#include "fft_bench.h"
+#include "fft_simd.h"
+#include "fft_batch.h"
+
+using namespace std;
+
+const size_t BATCH_SIGNALS = 8;
+const size_t BATCH_MAX_N = size_t(1) << 20;
+
+// c_b and 1 / c_b, both exact in floating point
+Complex batch_scale(size_t b, bool inverse) {
+    static const Complex rot[4] = { Complex(1, 0), Complex(0, 1), Complex(-1, 0), Complex(0, -1) };
+    Complex r = inverse ? conj(rot[b % 4]) : rot[b % 4];
+    return r * ldexp(1.0, inverse ? (int)(b / 4) : -(int)(b / 4));
+}
+
+// Speed and accuracy sweep of the shared-memory FFT: every N = 2^min .. 2^max,
+// every thread count (1 = serial, more = OpenMP), the plan's automatic choice
+// or, with --all, every algorithm fft_wisdom.h would try. Reports the median
+// time, GFLOP/s (5 N log2 N) and relative error against a high-precision
+// reference (see fft_bench.h); mpi_fft_bench adds the MPI variant.
+// Each N also gets a "split" row (SplitFftPlan, serial, with the SIMD kernel
+// picked at run time; the timing includes restoring its in-place input) and,
+// up to BATCH_MAX_N, "batch" rows: BatchFftPlan on BATCH_SIGNALS signals,
+// contiguous and interleaved (stride BATCH_SIGNALS, dist 1), with the time
+// per signal. Batch signal b is c_b x for c_b = i^b 2^-(b/4), an exact
+// scaling, so each output is checked against c_b X_ref.
+// Usage: ./fft_bench [--min 4] [--max 26] [-t 1,2,4] [--all] [--samples 7]
+//                    [--csv file] [--json file] [--tag name]
+int main(int argc, char** argv) {
+    int min_log = 4, max_log = 26, samples = 7;
+    bool all = false;
+    string csv, json, tag = "untagged";
+    vector<int> threads = {1};
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1) threads.push_back(omp_get_max_threads());
+#endif
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--min" && i + 1 < argc) min_log = atoi(argv[++i]);
+        else if (arg == "--max" && i + 1 < argc) max_log = atoi(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc) threads = parse_int_list(argv[++i]);
+        else if (arg == "--all") all = true;
+        else if (arg == "--samples" && i + 1 < argc) samples = atoi(argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc) csv = argv[++i];
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else if (arg == "--tag" && i + 1 < argc) tag = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--min log2N] [--max log2N] [-t threads,...] [--all] [--samples n]"
+                 << " [--csv file] [--json file] [--tag name]" << endl;
+            return 1;
+        }
+    }
+
+    try {
+        BenchReport report(tag, csv, json);
+        for (int lg = min_log; lg <= max_log; ++lg) {
+            size_t N = size_t(1) << lg;
+            AlignedComplexVector x(N), X(N);
+            vector<complex<long double> > ref;
+            unique_ptr<ToneSignal> tones;
+            if (!bench_exact_reference(N)) {
+                random_signal(x.data(), 0, N);
+                ref = reference_spectrum(N);
+            } else {
+                tones.reset(new ToneSignal(N));
+                tones->generate(x.data(), 0, N);
+            }
+
+            auto accumulate = [&](const Complex* Y, long double& err2, long double& ref2) {
+                if (tones) tones->accumulate_error(Y, 0, N, err2, ref2);
+                else accumulate_error(Y, ref.data(), N, err2, ref2);
+            };
+            auto add = [&](const string& variant, const string& algorithm, int t, double per_transform,
+                           double best, long double err2, long double ref2) {
+                BenchResult r;
+                r.variant = variant;
+                r.algorithm = algorithm;
+                r.N = N;
+                r.ranks = 1;
+                r.threads = t;
+                r.median = per_transform;
+                r.best = best;
+                r.gflops = 5.0 * N * lg / r.median * 1e-9;
+                r.error = (double)sqrtl(err2 / ref2);
+                r.reference = tones ? "exact_tones" : "long_double";
+                report.add(r);
+            };
+
+            vector<FftVariant> variants(1, FftVariant());
+            if (all) variants = fft_candidates(N);
+            for (int t : threads) {
+                for (const FftVariant& v : variants) {
+                    FftPlan plan(N, FFT_FORWARD, t, v);
+                    plan.execute(x.data(), X.data());
+                    long double err2 = 0, ref2 = 0;
+                    accumulate(X.data(), err2, ref2);
+                    double median, best;
+                    time_median([&] { plan.execute(x.data(), X.data()); }, samples, median, best);
+                    add(t > 1 ? "openmp" : "serial", variant_label(plan.variant()), t, median, best, err2, ref2);
+                }
+
+                // Split layout (serial): the in-place input is restored before each run
+                if (t == 1) {
+                    SplitFftPlan split(N);
+                    AlignedVector<double> re0(N), im0(N), re(N), im(N);
+                    split_complex(x.data(), re0.data(), im0.data(), N);
+                    auto run = [&] {
+                        copy(re0.begin(), re0.end(), re.begin());
+                        copy(im0.begin(), im0.end(), im.begin());
+                        split.execute(re.data(), im.data());
+                    };
+                    run();
+                    interleave_complex(re.data(), im.data(), X.data(), N);
+                    long double err2 = 0, ref2 = 0;
+                    accumulate(X.data(), err2, ref2);
+                    double median, best;
+                    time_median(run, samples, median, best);
+                    add("split", string("radix2-") + split.kernel_name(), t, median, best, err2, ref2);
+                }
+
+                // Batches of c_b x, contiguous then interleaved
+                for (int strided = 0; strided < 2 && N <= BATCH_MAX_N; ++strided) {
+                    size_t stride = strided ? BATCH_SIGNALS : 1, dist = strided ? 1 : N;
+                    BatchFftPlan batch(N, BATCH_SIGNALS, FFT_FORWARD, t, stride, dist);
+                    AlignedComplexVector xs(N * BATCH_SIGNALS), Xs(N * BATCH_SIGNALS);
+                    for (size_t b = 0; b < BATCH_SIGNALS; ++b) {
+                        Complex c = batch_scale(b, false);
+                        for (size_t j = 0; j < N; ++j) xs[b * dist + j * stride] = c * x[j];
+                    }
+                    batch.execute(xs.data(), Xs.data());
+                    long double err2 = 0, ref2 = 0;
+                    for (size_t b = 0; b < BATCH_SIGNALS; ++b) {
+                        Complex c = batch_scale(b, true);
+                        for (size_t j = 0; j < N; ++j) X[j] = c * Xs[b * dist + j * stride];
+                        accumulate(X.data(), err2, ref2);
+                    }
+                    double median, best;
+                    time_median([&] { batch.execute(xs.data(), Xs.data()); }, samples, median, best);
+                    string algorithm = batch.vectorized_across_signals()
+                        ? string("lanes") : variant_label(FftPlan(N, FFT_FORWARD, 1).variant());
+                    add("batch", algorithm + (strided ? "-strided" : ""), t, median / BATCH_SIGNALS,
+                        best / BATCH_SIGNALS, err2, ref2);
+                }
+            }
+        }
+        report.finish();
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+#ifndef FFT_BENCH_H
+#define FFT_BENCH_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cfloat>
+#include <stdexcept>
+#include "fft.h"
+#include "fft_wisdom.h"
+
+// Shared pieces of the benchmark drivers (fft_bench.cpp, mpi_fft_bench.cpp):
+// test signals with a high-precision reference spectrum, median timing, and
+// the table / CSV / JSON report.
+//
+// Accuracy is the relative L2 error ||X - X_ref|| / ||X_ref||. Up to
+// BENCH_REF_MAX points the input is random and X_ref is the FftPlanL (long
+// double) transform of it. Beyond that a long double reference costs more
+// memory than the transform under test, so the input is a sum of
+// BENCH_TONES on-bin complex exponentials whose spectrum is known exactly
+// (N * amplitude at each tone's bin, zero elsewhere); the samples are built
+// in long double from exactly reduced phases. Where long double is no wider
+// than double (Apple M1, MSVC) FftPlanL would repeat the computation under
+// test, so the tones are used at every N. Each result names its reference.
+
+// Largest N checked against a long double FFT
+const std::size_t BENCH_REF_MAX = std::size_t(1) << 22;
+// Whether long double carries more precision than double, so FftPlanL is a reference
+const bool BENCH_LONG_DOUBLE_REF = LDBL_MANT_DIG > DBL_MANT_DIG;
+// Tones in the exact-spectrum signal
+const int BENCH_TONES = 8;
+// Each timing sample repeats the transform until it lasts this long (seconds)
+const double BENCH_MIN_SAMPLE = 0.02;
+
+// splitmix64: a sample depends only on its index and the seed, so every
+// rank can generate its own block of the same signal
+inline std::uint64_t bench_hash(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Uniform in [-1, 1)
+inline double bench_uniform(std::uint64_t key) {
+    return (bench_hash(key) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+// Random input: x[first .. first+count)
+inline void random_signal(Complex* x, std::size_t first, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t n = first + i;
+        x[i] = Complex(bench_uniform(2 * n), bench_uniform(2 * n + 1));
+    }
+}
+
+// Whether N is checked against the exact tone spectrum rather than a long double FFT
+inline bool bench_exact_reference(std::size_t N) {
+    return N > BENCH_REF_MAX || !BENCH_LONG_DOUBLE_REF;
+}
+
+// Long double FFT of the full random input of length N
+inline std::vector<std::complex<long double> > reference_spectrum(std::size_t N) {
+    std::vector<Complex> x(N);
+    random_signal(x.data(), 0, N);
+    std::vector<std::complex<long double> > xl(x.begin(), x.end()), X(N);
+    FftPlanL(N).execute(xl.data(), X.data());
+    return X;
+}
+
+// Sum of on-bin tones with an exactly known spectrum
+class ToneSignal {
+public:
+    explicit ToneSignal(std::size_t N) : N_(N) {
+        for (int j = 0; j < BENCH_TONES; ++j) {
+            bins_.push_back(bench_hash(1000 + j) % N);
+            amps_.push_back(std::complex<long double>(bench_uniform(2000 + 2 * j), bench_uniform(2001 + 2 * j)));
+        }
+        // X[bin] = N * (sum of the amplitudes at that bin)
+        spectrum_bins_ = bins_;
+        std::sort(spectrum_bins_.begin(), spectrum_bins_.end());
+        spectrum_bins_.erase(std::unique(spectrum_bins_.begin(), spectrum_bins_.end()), spectrum_bins_.end());
+        spectrum_.assign(spectrum_bins_.size(), 0);
+        for (int j = 0; j < BENCH_TONES; ++j) {
+            std::size_t t = std::lower_bound(spectrum_bins_.begin(), spectrum_bins_.end(), bins_[j]) - spectrum_bins_.begin();
+            spectrum_[t] += amps_[j] * (long double)N;
+        }
+        // exp(2πi e/N) = hi_[e / split_] * lo_[e % split_], in long double
+        split_ = 1;
+        while (split_ * split_ < N) split_ <<= 1;
+        lo_.resize(split_);
+        hi_.resize(N / split_ + 1);
+        for (std::size_t e = 0; e < split_; ++e) lo_[e] = unit_root<long double>(1, e, N);
+        for (std::size_t h = 0; h < hi_.size(); ++h) hi_[h] = unit_root<long double>(1, (unsigned long long)h * split_ % N, N);
+    }
+
+    // x[first .. first+count)
+    void generate(Complex* x, std::size_t first, std::size_t count) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t n = first + i;
+            std::complex<long double> s = 0;
+            for (int j = 0; j < BENCH_TONES; ++j) {
+                std::size_t e = (std::size_t)((unsigned long long)bins_[j] * n % N_);
+                s += amps_[j] * hi_[e / split_] * lo_[e % split_];
+            }
+            x[i] = Complex((double)s.real(), (double)s.imag());
+        }
+    }
+
+    // Adds the squared error and squared reference norm over bins [first, first+count)
+    void accumulate_error(const Complex* X, std::size_t first, std::size_t count, long double& err2,
+                          long double& ref2) const {
+        // Tone bins in increasing order, walked alongside k
+        std::size_t t = std::lower_bound(spectrum_bins_.begin(), spectrum_bins_.end(), first) - spectrum_bins_.begin();
+        for (std::size_t k = 0; k < count; ++k) {
+            std::complex<long double> v(X[k]);
+            if (t < spectrum_bins_.size() && spectrum_bins_[t] == first + k) {
+                v -= spectrum_[t];
+                ref2 += std::norm(spectrum_[t]);
+                ++t;
+            }
+            err2 += std::norm(v);
+        }
+    }
+
+private:
+    std::size_t N_, split_;
+    std::vector<std::size_t> bins_, spectrum_bins_;
+    std::vector<std::complex<long double> > amps_, spectrum_, lo_, hi_;
+};
+
+// Adds the squared error and squared reference norm of X against ref
+inline void accumulate_error(const Complex* X, const std::complex<long double>* ref, std::size_t count,
+                             long double& err2, long double& ref2) {
+    for (std::size_t k = 0; k < count; ++k) {
+        err2 += std::norm(std::complex<long double>(X[k]) - ref[k]);
+        ref2 += std::norm(ref[k]);
+    }
+}
+
+// Median and minimum seconds per call of f over `samples` samples. Each
+// sample repeats f until it lasts BENCH_MIN_SAMPLE; agree() maps a local
+// duration to the one every process uses (the max over MPI ranks), so all
+// ranks pick the same repeat count.
+inline void time_median(const std::function<void()>& f, int samples, double& median, double& best,
+                        const std::function<double(double)>& agree = [](double t) { return t; }) {
+    auto run = [&](long long reps) {
+        auto start = std::chrono::steady_clock::now();
+        for (long long r = 0; r < reps; ++r) f();
+        return agree(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+    f();   // warm-up
+    long long reps = 1;
+    double t = run(reps);
+    while (t < BENCH_MIN_SAMPLE) {
+        reps = t > 0 ? std::max(2 * reps, (long long)(reps * 1.2 * BENCH_MIN_SAMPLE / t)) : 2 * reps;
+        t = run(reps);
+    }
+    std::vector<double> per_call(1, t / reps);
+    for (int s = 1; s < samples; ++s) per_call.push_back(run(reps) / reps);
+    std::sort(per_call.begin(), per_call.end());
+    std::size_t n = per_call.size();
+    median = n % 2 ? per_call[n / 2] : 0.5 * (per_call[n / 2 - 1] + per_call[n / 2]);
+    best = per_call[0];
+}
+
+struct BenchResult {
+    std::string variant;     // serial, openmp, mpi
+    std::string algorithm;   // plan algorithm (with radix or leaf)
+    std::size_t N;
+    int ranks, threads;
+    double median, best;     // seconds per transform
+    double gflops;           // 5 N log2 N / median
+    double error;            // relative L2 error
+    std::string reference;   // long_double or exact_tones
+};
+
+inline std::string variant_label(const FftVariant& v) {
+    std::ostringstream s;
+    s << algorithm_name(v.algorithm);
+    if (v.algorithm == FFT_STOCKHAM) s << "-r" << v.radix;
+    if (v.algorithm == FFT_RECURSIVE) s << "-leaf" << v.leaf;
+    return s.str();
+}
+
+// Results as a console table, plus optional CSV (appended row by row, so a
+// long sweep keeps what it measured) and JSON (written by finish()). Every
+// row carries the tag, e.g. the commit being measured.
+class BenchReport {
+public:
+    BenchReport(const std::string& tag, const std::string& csv_path, const std::string& json_path)
+        : tag_(tag), json_path_(json_path) {
+        if (!csv_path.empty()) {
+            bool fresh = !std::ifstream(csv_path.c_str()).good();
+            csv_.open(csv_path.c_str(), std::ios::app);
+            if (!csv_) throw std::runtime_error("cannot write " + csv_path);
+            if (fresh) csv_ << "tag,variant,algorithm,N,ranks,threads,median_s,min_s,gflops,rel_error,reference\n";
+        }
+        std::cout << std::setw(9) << "variant" << std::setw(20) << "algorithm" << std::setw(10) << "N"
+                  << std::setw(6) << "ranks" << std::setw(8) << "threads" << std::setw(13) << "median (us)"
+                  << std::setw(10) << "GFLOP/s" << std::setw(12) << "rel. error" << "  reference" << std::endl;
+    }
+
+    void add(const BenchResult& r) {
+        rows_.push_back(r);
+        std::cout << std::setw(9) << r.variant << std::setw(20) << r.algorithm << std::setw(10) << r.N
+                  << std::setw(6) << r.ranks << std::setw(8) << r.threads << std::setw(13) << r.median * 1e6
+                  << std::setw(10) << r.gflops << std::setw(12) << r.error << "  " << r.reference << std::endl;
+        if (csv_.is_open()) {
+            csv_ << std::setprecision(6) << tag_ << ',' << r.variant << ',' << r.algorithm << ',' << r.N << ','
+                 << r.ranks << ',' << r.threads << ',' << r.median << ',' << r.best << ',' << r.gflops << ','
+                 << r.error << ',' << r.reference << '\n';
+            csv_.flush();
+        }
+    }
+
+    void finish() const {
+        if (json_path_.empty()) return;
+        std::ofstream out(json_path_.c_str());
+        if (!out) throw std::runtime_error("cannot write " + json_path_);
+        out << std::setprecision(6) << "{\n  \"tag\": \"" << tag_ << "\",\n  \"results\": [";
+        for (std::size_t i = 0; i < rows_.size(); ++i) {
+            const BenchResult& r = rows_[i];
+            out << (i ? ",\n" : "\n") << "    {\"variant\": \"" << r.variant << "\", \"algorithm\": \"" << r.algorithm
+                << "\", \"N\": " << r.N << ", \"ranks\": " << r.ranks << ", \"threads\": " << r.threads
+                << ", \"median_s\": " << r.median << ", \"min_s\": " << r.best << ", \"gflops\": " << r.gflops
+                << ", \"rel_error\": " << r.error << ", \"reference\": \"" << r.reference << "\"}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    std::string tag_, json_path_;
+    std::ofstream csv_;
+    std::vector<BenchResult> rows_;
+};
+
+// "1,2,8" -> {1, 2, 8}
+inline std::vector<int> parse_int_list(const std::string& s) {
+    std::vector<int> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) v.push_back(std::atoi(item.c_str()));
+    }
+    return v;
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef FFT_CODELETS_H
+#define FFT_CODELETS_H
+
+#include <complex>
+#include <cstddef>
+
+// Straight-line FFT codelets for N = 2, 4, ..., 64, generated at compile time.
+// FftCodelet<N, Dir, Real>::run() expands by template recursion into a fully
+// unrolled radix-2 decimation-in-time transform: no loops, no calls, no
+// allocation, and every twiddle is a compile-time constant computed by the
+// constexpr sine/cosine below. Multiplications by 1 and by ±i are removed
+// entirely. Input may be strided, so the codelets also serve as the leaves
+// of the recursive large-N FFT.
+// Needs C++14 (constexpr loops); build with -std=c++14 or later.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FFT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define FFT_ALWAYS_INLINE inline
+#endif
+
+const std::size_t FFT_CODELET_MAX = 64;
+
+// sin and cos of φ in [0, π/4] by Taylor series (terms vanish below 1e-30)
+constexpr long double ct_sin_small(long double x) {
+    long double term = x, sum = x;
+    for (int n = 1; n < 15; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr long double ct_cos_small(long double x) {
+    long double term = 1, sum = 1;
+    for (int n = 1; n < 15; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+// cos/sin(2πk/N) with exact integer reduction to the first octant
+constexpr long double ct_root(unsigned long long k, unsigned long long N, bool want_sin) {
+    const long double half_pi = 1.570796326794896619231321691639751442L;
+    k %= N;
+    unsigned long long q = (4 * k) / N;          // quadrant
+    unsigned long long r = 4 * k - q * N;        // θ = (q + r/N) π/2
+    bool upper = 2 * r > N;                      // reflect into [0, π/4]
+    long double phi = upper ? half_pi * (long double)(N - r) / N : half_pi * (long double)r / N;
+    long double c = upper ? ct_sin_small(phi) : ct_cos_small(phi);
+    long double s = upper ? ct_cos_small(phi) : ct_sin_small(phi);
+    // Rotate (c, s) by q quarter turns
+    long double cq = q == 0 ? c : q == 1 ? -s : q == 2 ? -c : s;
+    long double sq = q == 0 ? s : q == 1 ? c : q == 2 ? -s : -c;
+    return want_sin ? sq : cq;
+}
+
+// exp(Dir * 2πiK/N) as compile-time constants
+template <std::size_t N, std::size_t K, int Dir, typename Real>
+struct CodeletTwiddle {
+    static constexpr Real re = (Real)ct_root(K, N, false);
+    static constexpr Real im = (Real)(Dir * ct_root(K, N, true));
+};
+
+// Butterflies k = K .. N/2-1 of the combine step, unrolled
+template <std::size_t N, std::size_t K, int Dir, typename Real, bool Done = (2 * K >= N)>
+struct CodeletCombine {
+    static FFT_ALWAYS_INLINE void run(std::complex<Real>* out) {
+        typedef CodeletTwiddle<N, K, Dir, Real> W;
+        Real br = out[K + N / 2].real(), bi = out[K + N / 2].imag();
+        Real tr, ti;
+        if (K == 0) {
+            tr = br; ti = bi;
+        } else if (4 * K == N) {
+            // w = Dir * i
+            tr = -Dir * bi; ti = Dir * br;
+        } else {
+            tr = W::re * br - W::im * bi;
+            ti = W::re * bi + W::im * br;
+        }
+        Real ar = out[K].real(), ai = out[K].imag();
+        out[K] = std::complex<Real>(ar + tr, ai + ti);
+        out[K + N / 2] = std::complex<Real>(ar - tr, ai - ti);
+        CodeletCombine<N, K + 1, Dir, Real>::run(out);
+    }
+};
+
+template <std::size_t N, std::size_t K, int Dir, typename Real>
+struct CodeletCombine<N, K, Dir, Real, true> {
+    static FFT_ALWAYS_INLINE void run(std::complex<Real>*) {}
+};
+
+// out[0..N) = FFT of in[0], in[is], ..., in[(N-1)*is]
+template <std::size_t N, int Dir, typename Real>
+struct FftCodelet {
+    static FFT_ALWAYS_INLINE void run(const std::complex<Real>* in, std::size_t is, std::complex<Real>* out) {
+        FftCodelet<N / 2, Dir, Real>::run(in, 2 * is, out);
+        FftCodelet<N / 2, Dir, Real>::run(in + is, 2 * is, out + N / 2);
+        CodeletCombine<N, 0, Dir, Real>::run(out);
+    }
+};
+
+template <int Dir, typename Real>
+struct FftCodelet<2, Dir, Real> {
+    static FFT_ALWAYS_INLINE void run(const std::complex<Real>* in, std::size_t is, std::complex<Real>* out) {
+        std::complex<Real> a = in[0], b = in[is];
+        out[0] = a + b;
+        out[1] = a - b;
+    }
+};
+
+template <int Dir, typename Real>
+struct FftCodelet<1, Dir, Real> {
+    static FFT_ALWAYS_INLINE void run(const std::complex<Real>* in, std::size_t, std::complex<Real>* out) {
+        out[0] = in[0];
+    }
+};
+
+// Out-of-line entry points (one function per size and direction), so
+// runtime dispatch costs a single indirect call
+template <std::size_t N, int Dir, typename Real>
+void fft_codelet(const std::complex<Real>* in, std::size_t is, std::complex<Real>* out) {
+    FftCodelet<N, Dir, Real>::run(in, is, out);
+}
+
+template <typename Real>
+struct CodeletFn {
+    typedef void (*type)(const std::complex<Real>*, std::size_t, std::complex<Real>*);
+};
+
+// Codelet for N (power of two up to FFT_CODELET_MAX) and direction sign, or null.
+// Codelets work out of place: in and out must not overlap.
+template <typename Real>
+inline typename CodeletFn<Real>::type find_codelet(std::size_t N, int dir) {
+    typedef typename CodeletFn<Real>::type Fn;
+    static const Fn forward[] = { fft_codelet<1, -1, Real>, fft_codelet<2, -1, Real>, fft_codelet<4, -1, Real>,
+                                  fft_codelet<8, -1, Real>, fft_codelet<16, -1, Real>, fft_codelet<32, -1, Real>,
+                                  fft_codelet<64, -1, Real> };
+    static const Fn backward[] = { fft_codelet<1, 1, Real>, fft_codelet<2, 1, Real>, fft_codelet<4, 1, Real>,
+                                   fft_codelet<8, 1, Real>, fft_codelet<16, 1, Real>, fft_codelet<32, 1, Real>,
+                                   fft_codelet<64, 1, Real> };
+    for (int b = 0; b <= 6; ++b) {
+        if (N == (std::size_t(1) << b)) return dir < 0 ? forward[b] : backward[b];
+    }
+    return 0;
+}
+
+#endif
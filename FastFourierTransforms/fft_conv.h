@@ -0,0 +1,254 @@
+#ifndef FFT_CONV_H
+#define FFT_CONV_H
+
+#include "fft_real.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Linear convolution and cross-correlation of real signals with a fixed kernel.
+//
+// ConvolutionPlan takes the kernel h[0..M) once; convolve() then produces the
+// full convolution y[i] = sum_j h[j] x[i-j], i = 0 .. n+M-2, for inputs of
+// any length n. Two methods:
+//  - CONV_DIRECT: the O(n*M) sum, written as one axpy per tap so it
+//    vectorizes; cheapest for short kernels.
+//  - CONV_FFT: overlap-save. The input (with M-1 zeros in front) is cut into
+//    blocks of L samples overlapping by M-1; each block is transformed with a
+//    real FFT, multiplied by the kernel's precomputed spectrum and
+//    transformed back, and the last L-M+1 outputs are kept (the first M-1
+//    are wrapped-around garbage). L is the power of two with the lowest cost
+//    per output sample, so memory stays O(L) however long the input.
+// CONV_AUTO compares the two cost estimates. A kernel longer than
+// CONV_MAX_BLOCK / 2 leaves no block to choose, so a plan for it is direct;
+// fft_convolve() instead multiplies such signals with one full-length FFT.
+//
+// convolve_batch() runs several channels through the same plan. Threads go
+// over channels, or over overlap-save blocks for a single channel; every
+// thread has its own FFT plans and buffers, allocated at plan time.
+//
+// Correlation r[lag] = sum_n x[n+lag] h[n] is convolution with the reversed
+// kernel: correlation_plan(h) returns that plan, whose output index i holds
+// lag i - (M-1).
+enum ConvMethod { CONV_AUTO, CONV_DIRECT, CONV_FFT };
+
+// Largest overlap-save block considered
+const std::size_t CONV_MAX_BLOCK = 1 << 16;
+
+// One direct tap per output sample, in FFT-flop units: the direct loop is a
+// stream of full-width vector multiply-adds, which run several times faster
+// per flop than FFT butterflies (measured crossover near M = 150)
+const double CONV_DIRECT_COST = 0.4;
+
+// Direct convolution processes this many outputs per pass over the kernel,
+// so the slice of x and y in use stays in L1
+const std::size_t CONV_DIRECT_CHUNK = 2048;
+
+// Whether an overlap-save block (a power of two, at least twice the next
+// power of two >= M) fits in CONV_MAX_BLOCK for a kernel of M taps
+inline bool conv_block_fits(std::size_t M) {
+    std::size_t L = 2;
+    while (L < M) L <<= 1;
+    return 2 * L <= CONV_MAX_BLOCK;
+}
+
+class ConvolutionPlan {
+public:
+    // n_hint: typical input length, used to size the blocks (0 = long streams)
+    ConvolutionPlan(const std::vector<double>& kernel, ConvMethod method = CONV_AUTO, int threads = 1,
+                    std::size_t n_hint = 0)
+        : h_(kernel), threads_(threads < 1 ? 1 : threads), L_(0) {
+        if (kernel.empty()) throw std::invalid_argument("ConvolutionPlan: kernel must not be empty");
+        std::size_t M = kernel.size();
+        if (!conv_block_fits(M) && method == CONV_FFT) {
+            throw std::invalid_argument("ConvolutionPlan: kernel too long for CONV_MAX_BLOCK");
+        }
+
+        // Cost per output sample, counting ~2.5 L log2 L flops per real FFT
+        // of length L (two per block) plus the spectrum product, over the
+        // L-M+1 outputs each block yields; direct costs CONV_DIRECT_COST per tap
+        double best = -1;
+        std::size_t L = 2;
+        while (L < M) L <<= 1;
+        for (L *= 2; L <= CONV_MAX_BLOCK; L <<= 1) {
+            double per_block = 5.0 * L * std::log2((double)L) + 3.0 * L;
+            double c = per_block / (L - M + 1);
+            if (best < 0 || c < best) {
+                best = c;
+                L_ = L;
+            }
+            // Blocks beyond one per input gain nothing
+            if (n_hint && L >= n_hint + M - 1) break;
+        }
+        if (method == CONV_AUTO) method = (L_ == 0 || CONV_DIRECT_COST * M <= best) ? CONV_DIRECT : CONV_FFT;
+        method_ = method;
+        if (method_ == CONV_FFT) init_fft();
+    }
+
+    std::size_t kernel_size() const { return h_.size(); }
+    ConvMethod method() const { return method_; }
+    // Overlap-save block length (0 for direct)
+    std::size_t block_size() const { return method_ == CONV_FFT ? L_ : 0; }
+    // Output samples for an input of n samples
+    std::size_t output_size(std::size_t n) const { return n + h_.size() - 1; }
+
+    // out[0 .. n+M-1) = full convolution of in[0..n) with the kernel
+    void convolve(const double* in, std::size_t n, double* out) const {
+        convolve_batch(in, n, 1, out);
+    }
+
+    void convolve(const std::vector<double>& in, std::vector<double>& out) const {
+        out.resize(output_size(in.size()));
+        convolve(in.data(), in.size(), out.data());
+    }
+
+    // channels signals of n samples, channel c at in[c*n]; output channel c at out[c*(n+M-1)]
+    void convolve_batch(const double* in, std::size_t n, std::size_t channels, double* out) const {
+        if (n == 0) {
+            std::fill(out, out + channels * output_size(0), 0.0);
+            return;
+        }
+        std::size_t ny = output_size(n);
+        if (channels == 1) {
+            run(in, n, out, 0, threads_);
+            return;
+        }
+        #pragma omp parallel for schedule(dynamic) num_threads(threads_) if(threads_ > 1)
+        for (long long c = 0; c < (long long)channels; ++c) {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            run(in + c * n, n, out + c * ny, tid, 0);
+        }
+    }
+
+private:
+    // threads_here > 0: this call may spread over that many threads; 0: run serially as thread tid
+    void run(const double* in, std::size_t n, double* out, int tid, int threads_here) const {
+        if (method_ == CONV_DIRECT) {
+            direct(in, n, out);
+        } else {
+            overlap_save(in, n, out, tid, threads_here);
+        }
+    }
+
+    void direct(const double* x, std::size_t n, double* y) const {
+        std::size_t M = h_.size(), ny = n + M - 1;
+        std::fill(y, y + ny, 0.0);
+        // y[i0 .. i1) += h[j] * x[i - j], chunked over i
+        for (std::size_t i0 = 0; i0 < ny; i0 += CONV_DIRECT_CHUNK) {
+            std::size_t i1 = std::min(ny, i0 + CONV_DIRECT_CHUNK);
+            for (std::size_t j = 0; j < M; ++j) {
+                // i - j must lie in [0, n)
+                std::size_t lo = std::max(i0, j), hi = std::min(i1, n + j);
+                double hj = h_[j];
+                const double* xs = x - j;
+                #pragma omp simd
+                for (std::size_t i = lo; i < hi; ++i) y[i] += hj * xs[i];
+            }
+        }
+    }
+
+    void init_fft() {
+        // Kernel spectrum, with the c2r 1/L folded in
+        RealFftPlan plan(L_);
+        std::vector<double> padded(L_, 0.0);
+        std::copy(h_.begin(), h_.end(), padded.begin());
+        plan.r2c(padded, H_);
+        for (std::size_t k = 0; k < H_.size(); ++k) H_[k] /= (double)L_;
+
+        for (int t = 0; t < threads_; ++t) plans_.push_back(std::unique_ptr<RealFftPlan>(new RealFftPlan(L_)));
+        time_.resize(threads_ * L_);
+        spec_.resize(threads_ * H_.size());
+    }
+
+    // Block b covers padded input [b*S, b*S + L) with padded[i] = x[i - (M-1)]
+    // and yields y[b*S .. b*S + S)
+    void overlap_save(const double* x, std::size_t n, double* y, int tid, int threads_here) const {
+        std::size_t M = h_.size(), L = L_, S = L - M + 1;
+        std::size_t ny = n + M - 1;
+        long long blocks = (long long)((ny + S - 1) / S);
+        int t = threads_here > 1 ? std::min<long long>(threads_here, blocks) : 1;
+        (void)t;
+        #pragma omp parallel for schedule(static) num_threads(t) if(t > 1)
+        for (long long b = 0; b < blocks; ++b) {
+            int me = tid;
+#ifdef _OPENMP
+            if (t > 1) me = omp_get_thread_num();
+#endif
+            double* buf = time_.data() + me * L;
+            Complex* spec = spec_.data() + me * H_.size();
+            long long start = (long long)b * S - (long long)(M - 1);   // x index of buf[0]
+            for (std::size_t i = 0; i < L; ++i) {
+                long long xi = start + (long long)i;
+                buf[i] = (xi >= 0 && xi < (long long)n) ? x[xi] : 0.0;
+            }
+            plans_[me]->r2c(buf, spec);
+            // Written out: std::complex operator* carries NaN/inf recovery code
+            for (std::size_t k = 0; k < H_.size(); ++k) {
+                double ar = spec[k].real(), ai = spec[k].imag();
+                double br = H_[k].real(), bi = H_[k].imag();
+                spec[k] = Complex(ar * br - ai * bi, ar * bi + ai * br);
+            }
+            plans_[me]->c2r(spec, buf);
+            std::size_t y0 = (std::size_t)b * S;
+            std::size_t count = std::min(S, ny - y0);
+            std::copy(buf + M - 1, buf + M - 1 + count, y + y0);
+        }
+    }
+
+    std::vector<double> h_;
+    int threads_;
+    ConvMethod method_;
+    std::size_t L_;
+    std::vector<Complex> H_;
+    std::vector<std::unique_ptr<RealFftPlan> > plans_;
+    mutable AlignedVector<double> time_;
+    mutable AlignedComplexVector spec_;
+};
+
+// Plan whose output i is the cross-correlation of the input with h at lag i - (M-1)
+inline ConvolutionPlan correlation_plan(const std::vector<double>& h, ConvMethod method = CONV_AUTO,
+                                        int threads = 1, std::size_t n_hint = 0) {
+    return ConvolutionPlan(std::vector<double>(h.rbegin(), h.rend()), method, threads, n_hint);
+}
+
+// One-off full convolution of a and b (length a+b-1); the shorter one is the
+// kernel. When it is too long for an overlap-save block, both signals go
+// through one real FFT of the next power of two >= a+b-1.
+inline std::vector<double> fft_convolve(const std::vector<double>& a, const std::vector<double>& b,
+                                        int threads = 1) {
+    if (a.empty() || b.empty()) return std::vector<double>();
+    const std::vector<double>& x = a.size() >= b.size() ? a : b;
+    const std::vector<double>& h = a.size() >= b.size() ? b : a;
+    std::vector<double> y;
+    if (!conv_block_fits(h.size())) {
+        std::size_t ny = x.size() + h.size() - 1, L = 2;
+        while (L < ny) L <<= 1;
+        RealFftPlan plan(L, threads);
+        std::vector<double> buf(L, 0.0);
+        std::vector<Complex> X, H;
+        std::copy(x.begin(), x.end(), buf.begin());
+        plan.r2c(buf, X);
+        std::fill(buf.begin(), buf.end(), 0.0);
+        std::copy(h.begin(), h.end(), buf.begin());
+        plan.r2c(buf, H);
+        for (std::size_t k = 0; k < X.size(); ++k) X[k] *= H[k] / (double)L;
+        plan.c2r(X, buf);
+        buf.resize(ny);
+        return buf;
+    }
+    ConvolutionPlan(h, CONV_AUTO, threads, x.size()).convolve(x, y);
+    return y;
+}
+
+// One-off cross-correlation r[lag] = sum_n a[n+lag] b[n], lags -(|b|-1) .. |a|-1
+inline std::vector<double> fft_correlate(const std::vector<double>& a, const std::vector<double>& b,
+                                         int threads = 1) {
+    if (a.empty() || b.empty()) return std::vector<double>();
+    return fft_convolve(a, std::vector<double>(b.rbegin(), b.rend()), threads);
+}
+
+#endif
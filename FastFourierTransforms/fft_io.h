@@ -0,0 +1,289 @@
+#ifndef FFT_IO_H
+#define FFT_IO_H
+
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fft.h"
+
+// Binary complex-signal files, read and written through mmap.
+//
+// A file is a 64-byte header followed by the samples:
+//   offset  0  char[8]   magic "FFTSIG01"
+//           8  uint32    version (1)
+//          12  uint32    byte-order mark 0x01020304, as written by the host
+//          16  uint32    bytes per real (4 float, 8 double, sizeof(long double))
+//          20  uint32    layout: 0 interleaved (re, im, re, im, ...),
+//                                1 split (N reals, then N imaginaries)
+//          24  uint64    N, the number of complex samples
+//          32  uint64    byte offset of the samples (64)
+//          40  reserved, zero
+// Numbers are in host byte order; a file from a host of the other
+// endianness is rejected rather than silently misread.
+//
+// MappedSignal maps the whole file. An interleaved file of the plan's
+// precision is used in place: samples() points into the mapping, so an
+// FftPlanT can read its input straight from the page cache and write its
+// output straight into the output file, with no copies and no parsing.
+// load() and store() convert other layouts and precisions.
+
+const char SIGNAL_MAGIC[8] = { 'F', 'F', 'T', 'S', 'I', 'G', '0', '1' };
+const std::uint32_t SIGNAL_VERSION = 1;
+const std::uint32_t SIGNAL_BYTE_ORDER = 0x01020304;
+const std::size_t SIGNAL_HEADER_SIZE = 64;
+
+enum SignalLayout { SIGNAL_INTERLEAVED = 0, SIGNAL_SPLIT = 1 };
+
+struct SignalHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t real_bytes;
+    std::uint32_t layout;
+    std::uint64_t length;
+    std::uint64_t data_offset;
+    char reserved[24];
+};
+static_assert(sizeof(SignalHeader) == SIGNAL_HEADER_SIZE, "SignalHeader must be 64 bytes");
+
+// "float", "double", "long" -> bytes per real
+inline std::uint32_t parse_precision(const std::string& name) {
+    if (name == "float" || name == "single") return sizeof(float);
+    if (name == "double") return sizeof(double);
+    if (name == "long" || name == "long_double") return sizeof(long double);
+    throw std::invalid_argument("unknown precision: " + name);
+}
+
+inline const char* real_bytes_name(std::uint32_t bytes) {
+    return bytes == sizeof(float) ? "float" : bytes == sizeof(double) ? "double" : "long double";
+}
+
+inline SignalLayout parse_layout(const std::string& name) {
+    if (name == "interleaved") return SIGNAL_INTERLEAVED;
+    if (name == "split") return SIGNAL_SPLIT;
+    throw std::invalid_argument("unknown layout: " + name);
+}
+
+class MappedSignal {
+public:
+    // Map an existing signal file, read-only unless writable
+    static MappedSignal open(const std::string& path, bool writable = false) {
+        MappedSignal s(path, ::open(path.c_str(), writable ? O_RDWR : O_RDONLY));
+        struct stat st;
+        if (::fstat(s.fd_, &st) != 0) s.fail("stat");
+        if ((std::size_t)st.st_size < SIGNAL_HEADER_SIZE) throw std::runtime_error(path + ": not a signal file (too short)");
+        s.map((std::size_t)st.st_size, writable);
+        const SignalHeader& h = s.header();
+        if (std::memcmp(h.magic, SIGNAL_MAGIC, sizeof(SIGNAL_MAGIC)) != 0) throw std::runtime_error(path + ": not a signal file");
+        if (h.byte_order != SIGNAL_BYTE_ORDER) throw std::runtime_error(path + ": written with the other byte order");
+        if (h.version != SIGNAL_VERSION) throw std::runtime_error(path + ": unsupported version " + std::to_string(h.version));
+        if (h.real_bytes != sizeof(float) && h.real_bytes != sizeof(double) && h.real_bytes != sizeof(long double)) {
+            throw std::runtime_error(path + ": unsupported precision");
+        }
+        if (h.layout > SIGNAL_SPLIT) throw std::runtime_error(path + ": unknown layout");
+        if (h.data_offset + 2 * h.length * h.real_bytes > s.bytes_) throw std::runtime_error(path + ": truncated");
+        return s;
+    }
+
+    // Create (or replace) a file for N samples, sized up front and mapped read-write.
+    // keep_data leaves the bytes of an existing file in place: only the header
+    // and the file size change (for samples already written at SIGNAL_HEADER_SIZE).
+    static MappedSignal create(const std::string& path, std::size_t N, std::uint32_t real_bytes,
+                               SignalLayout layout = SIGNAL_INTERLEAVED, bool keep_data = false) {
+        MappedSignal s(path, ::open(path.c_str(), O_RDWR | O_CREAT | (keep_data ? 0 : O_TRUNC), 0644));
+        std::size_t bytes = SIGNAL_HEADER_SIZE + 2 * N * real_bytes;
+        if (::ftruncate(s.fd_, (off_t)bytes) != 0) s.fail("resize");
+        s.map(bytes, true);
+        SignalHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, SIGNAL_MAGIC, sizeof(SIGNAL_MAGIC));
+        h.version = SIGNAL_VERSION;
+        h.byte_order = SIGNAL_BYTE_ORDER;
+        h.real_bytes = real_bytes;
+        h.layout = layout;
+        h.length = N;
+        h.data_offset = SIGNAL_HEADER_SIZE;
+        std::memcpy(s.base_, &h, sizeof(h));
+        return s;
+    }
+
+    MappedSignal(MappedSignal&& o) : path_(o.path_), fd_(o.fd_), base_(o.base_), bytes_(o.bytes_) {
+        o.fd_ = -1;
+        o.base_ = nullptr;
+    }
+    MappedSignal(const MappedSignal&) = delete;
+    MappedSignal& operator=(const MappedSignal&) = delete;
+
+    ~MappedSignal() {
+        if (base_) ::munmap(base_, bytes_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    const SignalHeader& header() const { return *reinterpret_cast<const SignalHeader*>(base_); }
+    std::size_t size() const { return header().length; }
+    std::uint32_t real_bytes() const { return header().real_bytes; }
+    SignalLayout layout() const { return (SignalLayout)header().layout; }
+    std::size_t data_offset() const { return header().data_offset; }
+
+    // True when samples<Real>() can be used directly
+    template <typename Real>
+    bool is_native() const { return layout() == SIGNAL_INTERLEAVED && real_bytes() == sizeof(Real); }
+
+    // The samples in place (interleaved files of this precision only)
+    template <typename Real>
+    std::complex<Real>* samples() const {
+        if (!is_native<Real>()) throw std::invalid_argument(path_ + ": not interleaved " + real_bytes_name(sizeof(Real)));
+        return reinterpret_cast<std::complex<Real>*>(base_ + data_offset());
+    }
+
+    // Samples [first, first + count) into dst, converted from any layout and precision
+    template <typename Real>
+    void load(std::complex<Real>* dst, std::size_t first = 0, std::size_t count = std::size_t(-1)) const {
+        count = std::min(count, size() - first);
+        switch (real_bytes()) {
+        case sizeof(float): convert_from<float>(dst, first, count); break;
+        case sizeof(double): convert_from<double>(dst, first, count); break;
+        default: convert_from<long double>(dst, first, count); break;
+        }
+    }
+
+    // src into samples [first, first + count), converted to the file's layout and precision
+    template <typename Real>
+    void store(const std::complex<Real>* src, std::size_t first = 0, std::size_t count = std::size_t(-1)) {
+        count = std::min(count, size() - first);
+        switch (real_bytes()) {
+        case sizeof(float): convert_to<float>(src, first, count); break;
+        case sizeof(double): convert_to<double>(src, first, count); break;
+        default: convert_to<long double>(src, first, count); break;
+        }
+    }
+
+    // Ask the kernel to read the whole file ahead (sequential scans)
+    void prefetch() const {
+        ::madvise(base_, bytes_, MADV_SEQUENTIAL);
+        ::madvise(base_, bytes_, MADV_WILLNEED);
+    }
+
+    // Flush written samples to the file
+    void sync() const {
+        if (::msync(base_, bytes_, MS_SYNC) != 0) fail("sync");
+    }
+
+private:
+    MappedSignal(const std::string& path, int fd) : path_(path), fd_(fd), base_(nullptr), bytes_(0) {
+        if (fd_ < 0) fail("open");
+    }
+
+    void map(std::size_t bytes, bool writable) {
+        void* p = ::mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) fail("map");
+        base_ = static_cast<char*>(p);
+        bytes_ = bytes;
+    }
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error("cannot " + std::string(what) + " " + path_ + ": " + std::strerror(errno));
+    }
+
+    template <typename F, typename Real>
+    void convert_from(std::complex<Real>* dst, std::size_t first, std::size_t count) const {
+        const F* d = reinterpret_cast<const F*>(base_ + data_offset());
+        if (layout() == SIGNAL_INTERLEAVED) {
+            for (std::size_t i = 0; i < count; ++i) {
+                dst[i] = std::complex<Real>(Real(d[2 * (first + i)]), Real(d[2 * (first + i) + 1]));
+            }
+        } else {
+            const F* re = d + first;
+            const F* im = d + size() + first;
+            for (std::size_t i = 0; i < count; ++i) dst[i] = std::complex<Real>(Real(re[i]), Real(im[i]));
+        }
+    }
+
+    template <typename F, typename Real>
+    void convert_to(const std::complex<Real>* src, std::size_t first, std::size_t count) {
+        F* d = reinterpret_cast<F*>(base_ + data_offset());
+        if (layout() == SIGNAL_INTERLEAVED) {
+            for (std::size_t i = 0; i < count; ++i) {
+                d[2 * (first + i)] = F(src[i].real());
+                d[2 * (first + i) + 1] = F(src[i].imag());
+            }
+        } else {
+            F* re = d + first;
+            F* im = d + size() + first;
+            for (std::size_t i = 0; i < count; ++i) {
+                re[i] = F(src[i].real());
+                im[i] = F(src[i].imag());
+            }
+        }
+    }
+
+    std::string path_;
+    int fd_;
+    char* base_;
+    std::size_t bytes_;
+};
+
+// Test input for the command-line tools ("synth:N"): a sine of 3 cycles
+// plus an off-bin tone, sample n of N
+inline Complex synth_sample(std::size_t n, std::size_t N) {
+    return Complex(std::sin(2 * PI * 3.0 * n / N) + 0.5 * std::cos(2 * PI * 0.0123 * n), 0.25 * std::sin(0.001 * n));
+}
+
+// FFT of the signal file in_path (or "synth:N") into a new signal file
+// out_path of precision Real and the given layout. Interleaved files of
+// precision Real go through the plan with no copy; anything else is
+// converted through one buffer. Returns the seconds spent in the FFT.
+template <typename Real>
+inline double fft_file(const std::string& in_path, const std::string& out_path, SignalLayout out_layout,
+                       FftDirection dir = FFT_FORWARD, int threads = 1) {
+    typedef std::complex<Real> C;
+    std::size_t N;
+    std::unique_ptr<MappedSignal> in;
+    AlignedVector<C> in_buf;
+    const C* x;
+    if (in_path.compare(0, 6, "synth:") == 0) {
+        N = std::strtoull(in_path.c_str() + 6, nullptr, 10);
+        in_buf.resize(N);
+        for (std::size_t n = 0; n < N; ++n) in_buf[n] = C(synth_sample(n, N));
+        x = in_buf.data();
+    } else {
+        in.reset(new MappedSignal(MappedSignal::open(in_path)));
+        N = in->size();
+        if (in->is_native<Real>()) {
+            in->prefetch();
+            x = in->samples<Real>();
+        } else {
+            in_buf.resize(N);
+            in->load(in_buf.data());
+            x = in_buf.data();
+        }
+    }
+    if (N == 0) throw std::invalid_argument("fft_file: empty signal");
+
+    FftPlanT<Real> plan(N, dir, threads);
+    MappedSignal out = MappedSignal::create(out_path, N, sizeof(Real), out_layout);
+    AlignedVector<C> out_buf;
+    C* y;
+    if (out.is_native<Real>()) {
+        y = out.samples<Real>();
+    } else {
+        out_buf.resize(N);
+        y = out_buf.data();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    plan.execute(x, y);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!out_buf.empty()) out.store(out_buf.data());
+    return seconds;
+}
+
+#endif
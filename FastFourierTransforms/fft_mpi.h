@@ -0,0 +1,118 @@
+#ifndef FFT_MPI_H
+#define FFT_MPI_H
+
+#include <climits>
+#include <mpi.h>
+#include "fft.h"
+
+// Distributed-memory FFT using the six-step algorithm.
+// N = N1 * N2 and the signal is block-distributed: rank r owns the N/P
+// consecutive samples x[r*N/P .. (r+1)*N/P). Viewing x as an N1 x N2 row-major
+// matrix (n = n1*N2 + n2), each rank owns N1/P whole rows, and
+//   X[k1 + N1*k2] = sum_n2 W_N2^(n2 k2) W_N^(n2 k1) sum_n1 W_N1^(n1 k1) x[n1*N2 + n2]
+// which is computed as
+//   1. transpose N1 x N2 -> N2 x N1            (MPI_Alltoall)
+//   2. N2/P local row FFTs of length N1
+//   3. multiply by twiddles W_N^(n2 k1)
+//   4. transpose N2 x N1 -> N1 x N2            (MPI_Alltoall)
+//   5. N1/P local row FFTs of length N2
+//   6. transpose N1 x N2 -> N2 x N1            (MPI_Alltoall)
+// after which rank r owns X[r*N/P .. (r+1)*N/P) in natural order. No rank
+// ever holds more than a few N/P-sized buffers, so N can exceed one node's RAM.
+class MpiFftPlan {
+public:
+    // Picks N1 close to sqrt(N); P must divide both N1 and N2
+    MpiFftPlan(std::size_t N, MPI_Comm comm, FftDirection dir = FFT_FORWARD, int threads = 1)
+        : N_(N), comm_(comm) {
+        MPI_Comm_rank(comm, &rank_);
+        MPI_Comm_size(comm, &P_);
+        std::size_t P = P_;
+
+        N1_ = 0;
+        for (std::size_t n1 = P; n1 * n1 <= N; n1 += P) {
+            if (N % n1 == 0 && (N / n1) % P == 0) N1_ = n1;
+        }
+        if (N1_ == 0) throw std::invalid_argument("MpiFftPlan: N must factor as N1*N2 with both divisible by the rank count");
+        N2_ = N / N1_;
+        local_ = N / P;
+        // Each transpose sends N/P^2 complex values to every rank, counted in doubles
+        if (2 * (local_ / P) > (std::size_t)INT_MAX) {
+            throw std::invalid_argument("MpiFftPlan: N / P^2 too large for one MPI_Alltoall count; use more ranks");
+        }
+
+        row1_.reset(new FftPlan(N1_, dir, threads));
+        row2_.reset(new FftPlan(N2_, dir, threads));
+
+        // Step 3 twiddles for this rank's rows n2 of the N2 x N1 matrix
+        std::size_t rows = N2_ / P;
+        tw_.resize(local_);
+        for (std::size_t r = 0; r < rows; ++r) {
+            std::size_t n2 = rank_ * rows + r;
+            for (std::size_t k1 = 0; k1 < N1_; ++k1) {
+                std::size_t e = (std::size_t)(((unsigned long long)n2 * k1) % N);
+                tw_[r * N1_ + k1] = std::polar(1.0, dir * 2 * PI * e / N);
+            }
+        }
+        buf_.resize(local_);
+        scratch_.resize(std::max(row1_->scratch_size(), row2_->scratch_size()));
+    }
+
+    std::size_t size() const { return N_; }
+    std::size_t local_size() const { return local_; }
+    std::size_t local_start() const { return rank_ * local_; }
+    std::size_t n1() const { return N1_; }
+    std::size_t n2() const { return N2_; }
+
+    // in: this rank's N/P input samples; out: this rank's N/P output bins.
+    // Collective: every rank of the communicator must call it. in == out is allowed.
+    void execute(const Complex* in, Complex* out) const {
+        Complex* b = buf_.data();
+        transpose(in, b, N1_, N2_);                       // 1
+        for (std::size_t r = 0; r < N2_ / P_; ++r) {      // 2
+            row1_->execute(b + r * N1_, b + r * N1_, scratch_.data());
+        }
+        for (std::size_t i = 0; i < local_; ++i) b[i] *= tw_[i];   // 3
+        transpose(b, out, N2_, N1_);                      // 4
+        for (std::size_t r = 0; r < N1_ / P_; ++r) {      // 5
+            row2_->execute(out + r * N2_, out + r * N2_, scratch_.data());
+        }
+        transpose(out, b, N1_, N2_);                      // 6
+        std::copy(b, b + local_, out);
+    }
+
+private:
+    // Global transpose of an R x C row-major matrix whose rows are
+    // block-distributed (R/P rows per rank) into the C x R matrix distributed
+    // the same way. Each rank sends an (R/P) x (C/P) block to every rank.
+    void transpose(const Complex* in, Complex* out, std::size_t R, std::size_t C) const {
+        std::size_t P = P_, rl = R / P, cl = C / P, block = rl * cl;
+        send_.resize(local_);
+        recv_.resize(local_);
+        for (std::size_t d = 0; d < P; ++d) {
+            for (std::size_t i = 0; i < rl; ++i) {
+                const Complex* src = in + i * C + d * cl;
+                std::copy(src, src + cl, send_.data() + d * block + i * cl);
+            }
+        }
+        MPI_Alltoall(send_.data(), (int)(2 * block), MPI_DOUBLE,
+                     recv_.data(), (int)(2 * block), MPI_DOUBLE, comm_);
+        // Block from rank s holds rows s*rl.. of the input, columns of this rank
+        for (std::size_t s = 0; s < P; ++s) {
+            const Complex* blk = recv_.data() + s * block;
+            for (std::size_t i = 0; i < rl; ++i) {
+                for (std::size_t j = 0; j < cl; ++j) {
+                    out[j * R + s * rl + i] = blk[i * cl + j];
+                }
+            }
+        }
+    }
+
+    std::size_t N_, N1_, N2_, local_;
+    MPI_Comm comm_;
+    int rank_, P_;
+    std::unique_ptr<FftPlan> row1_, row2_;
+    AlignedComplexVector tw_;
+    mutable AlignedComplexVector buf_, scratch_, send_, recv_;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef FFT_ND_H
+#define FFT_ND_H
+
+#include "fft.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Multidimensional FFTs built from the 1D FftPlan.
+// Only rows (the contiguous last axis) are ever transformed. To reach the
+// other axes the data is transposed out of place with a cache-blocked
+// transpose, the new rows are transformed, and it is transposed back, so no
+// 1D transform strides through memory. Rows are processed in parallel with
+// OpenMP; each thread has its own plan scratch.
+
+// Tile edge for blocked transposes: a 32x32 tile of Complex is 16 KB,
+// so source and destination tiles fit in L1 together
+const std::size_t TRANSPOSE_BLOCK = 32;
+
+// out (cols x rows) = transpose of in (rows x cols), both row-major
+inline void transpose_blocked(const Complex* in, Complex* out, std::size_t rows, std::size_t cols,
+                              int threads = 1) {
+    const std::size_t B = TRANSPOSE_BLOCK;
+    long long row_blocks = (long long)((rows + B - 1) / B);
+    (void)threads;
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (long long ib = 0; ib < row_blocks; ++ib) {
+        std::size_t i0 = (std::size_t)ib * B, i1 = std::min(i0 + B, rows);
+        for (std::size_t j0 = 0; j0 < cols; j0 += B) {
+            std::size_t j1 = std::min(j0 + B, cols);
+            for (std::size_t i = i0; i < i1; ++i) {
+                for (std::size_t j = j0; j < j1; ++j) {
+                    out[j * rows + i] = in[i * cols + j];
+                }
+            }
+        }
+    }
+}
+
+// Transform `count` contiguous rows of plan.size() elements in place, rows split over threads
+inline void fft_rows(const FftPlan& plan, Complex* data, std::size_t count, int threads,
+                     AlignedComplexVector& scratch) {
+    std::size_t per_thread = plan.scratch_size();
+    scratch.resize(std::max<std::size_t>(1, threads * per_thread));
+    (void)threads;
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (long long r = 0; r < (long long)count; ++r) {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        Complex* row = data + (std::size_t)r * plan.size();
+        plan.execute(row, row, scratch.data() + tid * per_thread);
+    }
+}
+
+// 2D FFT of an n0 x n1 row-major array, in place
+class Fft2dPlan {
+public:
+    Fft2dPlan(std::size_t n0, std::size_t n1, FftDirection dir = FFT_FORWARD, int threads = 1)
+        : n0_(n0), n1_(n1), threads_(threads < 1 ? 1 : threads),
+          plan0_(n0, dir, 1), plan1_(n1, dir, 1), buf_(n0 * n1) {}
+
+    void execute(Complex* data) const {
+        fft_rows(plan1_, data, n0_, threads_, scratch_);             // along axis 1
+        transpose_blocked(data, buf_.data(), n0_, n1_, threads_);    // n1 x n0
+        fft_rows(plan0_, buf_.data(), n1_, threads_, scratch_);      // along axis 0
+        transpose_blocked(buf_.data(), data, n1_, n0_, threads_);
+    }
+
+    void execute(std::vector<Complex>& data) const {
+        if (data.size() != n0_ * n1_) throw std::invalid_argument("Fft2dPlan::execute: size does not match plan");
+        execute(data.data());
+    }
+
+private:
+    std::size_t n0_, n1_;
+    int threads_;
+    FftPlan plan0_, plan1_;
+    mutable AlignedComplexVector buf_, scratch_;
+};
+
+// 3D FFT of an n0 x n1 x n2 row-major array, in place.
+// Each pass transforms the contiguous axis and then rotates the axes
+// (a,b,c) -> (c,a,b) with one blocked transpose of an (a*b) x c matrix;
+// after three passes the data is back in its original layout.
+class Fft3dPlan {
+public:
+    Fft3dPlan(std::size_t n0, std::size_t n1, std::size_t n2, FftDirection dir = FFT_FORWARD, int threads = 1)
+        : n0_(n0), n1_(n1), n2_(n2), threads_(threads < 1 ? 1 : threads),
+          plan0_(n0, dir, 1), plan1_(n1, dir, 1), plan2_(n2, dir, 1), buf_(n0 * n1 * n2) {}
+
+    void execute(Complex* data) const {
+        std::size_t total = n0_ * n1_ * n2_;
+        Complex* a = data;
+        Complex* b = buf_.data();
+        // (n0,n1,n2): rows along axis 2
+        fft_rows(plan2_, a, total / n2_, threads_, scratch_);
+        transpose_blocked(a, b, n0_ * n1_, n2_, threads_);          // -> (n2,n0,n1)
+        fft_rows(plan1_, b, total / n1_, threads_, scratch_);
+        transpose_blocked(b, a, n2_ * n0_, n1_, threads_);          // -> (n1,n2,n0)
+        fft_rows(plan0_, a, total / n0_, threads_, scratch_);
+        transpose_blocked(a, b, n1_ * n2_, n0_, threads_);          // -> (n0,n1,n2)
+        std::copy(b, b + total, data);
+    }
+
+    void execute(std::vector<Complex>& data) const {
+        if (data.size() != n0_ * n1_ * n2_) throw std::invalid_argument("Fft3dPlan::execute: size does not match plan");
+        execute(data.data());
+    }
+
+private:
+    std::size_t n0_, n1_, n2_;
+    int threads_;
+    FftPlan plan0_, plan1_, plan2_;
+    mutable AlignedComplexVector buf_, scratch_;
+};
+
+#endif
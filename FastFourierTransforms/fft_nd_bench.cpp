@@ -0,0 +1,148 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <random>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "fft.h"
+#include "fft_nd.h"
+
+using namespace std;
+
+// Fft2dPlan and Fft3dPlan on each shape, with one thread and with -t threads,
+// checked against a reference that gathers every line along each axis and
+// transforms it with its own FftPlan (relative L2 error). Shapes are n0xn1 or
+// n0xn1xn2; the defaults mix odd, prime and non-square sizes.
+// Usage: ./fft_nd_bench [-t threads] [shape ...]
+//        e.g. ./fft_nd_bench -t 4 16x12x7 33x64x3 1024x768
+
+const double TOLERANCE = 1e-12;
+
+// Seconds per call, repeating until at least 0.2 s has elapsed
+template <typename F>
+double time_it(F f) {
+    int reps = 0;
+    double seconds = 0;
+    auto start = chrono::steady_clock::now();
+    while (seconds < 0.2) {
+        f();
+        ++reps;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    return seconds / reps;
+}
+
+// "16x12x7" -> {16, 12, 7}; empty on a malformed shape
+vector<size_t> parse_shape(const string& s) {
+    vector<size_t> dims;
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t end = s.find('x', pos);
+        if (end == string::npos) end = s.size();
+        string part = s.substr(pos, end - pos);
+        char* stop;
+        size_t n = strtoul(part.c_str(), &stop, 10);
+        if (part.empty() || *stop != '\0' || n == 0) return vector<size_t>();
+        dims.push_back(n);
+        pos = end + 1;
+    }
+    return dims;
+}
+
+// In-place FFT along every axis of a row-major array, one strided line at a time
+void reference_nd(vector<Complex>& a, const vector<size_t>& dims) {
+    size_t total = a.size(), stride = total;
+    for (size_t n : dims) {
+        stride /= n;   // distance between neighbours along this axis
+        FftPlan plan(n);
+        vector<Complex> line(n), out(n);
+        for (size_t base = 0; base < total; ++base) {
+            if ((base / stride) % n != 0) continue;   // not the start of a line
+            for (size_t j = 0; j < n; ++j) line[j] = a[base + j * stride];
+            plan.execute(line.data(), out.data());
+            for (size_t j = 0; j < n; ++j) a[base + j * stride] = out[j];
+        }
+    }
+}
+
+double relative_error(const vector<Complex>& y, const vector<Complex>& ref) {
+    double err = 0, norm_ref = 0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        err += norm(y[i] - ref[i]);
+        norm_ref += norm(ref[i]);
+    }
+    return norm_ref > 0 ? sqrt(err / norm_ref) : sqrt(err);
+}
+
+int main(int argc, char** argv) {
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    vector<vector<size_t> > shapes;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else {
+            vector<size_t> dims = parse_shape(arg);
+            if (dims.size() != 2 && dims.size() != 3) {
+                cerr << "Usage: " << argv[0] << " [-t threads] [n0xn1 | n0xn1xn2 ...]" << endl;
+                return 1;
+            }
+            shapes.push_back(dims);
+        }
+    }
+    if (shapes.empty()) {
+        shapes = { {16, 12}, {33, 64}, {1, 9}, {7, 1}, {512, 384},
+                   {16, 12, 7}, {33, 64, 3}, {1, 5, 1}, {64, 64, 64} };
+    }
+    vector<int> team = {1};
+    if (threads > 1) team.push_back(threads);
+
+    mt19937 rng(2024);
+    uniform_real_distribution<double> u(-1, 1);
+    bool all_ok = true;
+    cout << setw(14) << "shape" << setw(9) << "threads" << setw(12) << "time (ms)" << setw(12) << "GFLOP/s"
+         << setw(13) << "rel. error" << setw(8) << "check" << endl;
+    for (const vector<size_t>& dims : shapes) {
+        size_t total = 1;
+        string name;
+        for (size_t n : dims) {
+            total *= n;
+            name += (name.empty() ? "" : "x") + to_string(n);
+        }
+        vector<Complex> x(total);
+        for (Complex& v : x) v = Complex(u(rng), u(rng));
+        vector<Complex> ref = x;
+        reference_nd(ref, dims);
+
+        for (int t : team) {
+            vector<Complex> y = x;
+            double seconds;
+            if (dims.size() == 2) {
+                Fft2dPlan plan(dims[0], dims[1], FFT_FORWARD, t);
+                plan.execute(y);
+                vector<Complex> z;
+                seconds = time_it([&] { z = x; plan.execute(z); });
+            } else {
+                Fft3dPlan plan(dims[0], dims[1], dims[2], FFT_FORWARD, t);
+                plan.execute(y);
+                vector<Complex> z;
+                seconds = time_it([&] { z = x; plan.execute(z); });
+            }
+            double err = relative_error(y, ref);
+            bool ok = err < TOLERANCE;
+            all_ok = all_ok && ok;
+            double flops = total > 1 ? 5.0 * total * log2((double)total) : 0;
+            cout << setw(14) << name << setw(9) << t << setw(12) << seconds * 1e3 << setw(12)
+                 << flops / seconds * 1e-9 << setw(13) << err << setw(8) << (ok ? "ok" : "WRONG") << endl;
+        }
+    }
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+#ifndef FFT_OOC_H
+#define FFT_OOC_H
+
+#include <string>
+#include <future>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fft_nd.h"
+
+// Out-of-core FFT: transforms a signal stored in a file, holding only a
+// memory budget's worth of it in RAM at a time.
+//
+// Files hold N interleaved complex doubles (re, im) starting at a byte
+// offset. The algorithm is the six-step one of fft_mpi.h with the disk in
+// place of the other ranks: viewing x as an N1 x N2 row-major matrix
+// (n = n1*N2 + n2),
+//   X[k1 + N1*k2] = sum_n2 W_N2^(n2 k2) W_N^(n2 k1) sum_n1 W_N1^(n1 k1) x[n1*N2 + n2]
+// is computed in two passes over column slabs:
+//   1. read a slab of columns n2 of x (one strided read per row), transpose
+//      it in memory, FFT the rows (length N1), multiply by W_N^(n2 k1) and
+//      append the rows to a temporary N2 x N1 file (one contiguous write);
+//   2. read a slab of columns k1 of the temporary file, transpose, FFT the
+//      rows (length N2), transpose back and write the slab into the output,
+//      which then holds X in natural order as an N2 x N1 matrix.
+// Each pass keeps two input and two work slabs: while slab s is being
+// transformed, slab s+1 is read and slab s-1 written by background I/O
+// threads, so the disk and the FFT overlap. The slab width is the largest
+// that fits four slabs in the budget; wider slabs mean fewer, longer reads.
+//
+// I/O is pread/pwrite on plain file descriptors (POSIX): explicit block
+// reads keep the resident set at the budget, where a mapping of the whole
+// file would leave that to the page cache.
+
+// Slabs of one pass alive at once: input and work, each double-buffered
+const std::size_t OOC_SLABS = 4;
+
+// Owns a file descriptor; pread/pwrite whole ranges or throw
+class OocFile {
+public:
+    OocFile(const std::string& path, int flags) : path_(path), fd_(::open(path.c_str(), flags, 0644)), unlink_(false) {
+        if (fd_ < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    ~OocFile() {
+        ::close(fd_);
+        if (unlink_) ::unlink(path_.c_str());
+    }
+
+    // Remove the file when closed
+    void remove_on_close() { unlink_ = true; }
+
+    std::size_t size() const {
+        off_t end = ::lseek(fd_, 0, SEEK_END);
+        return end < 0 ? 0 : (std::size_t)end;
+    }
+
+    void read(void* dst, std::size_t bytes, std::size_t offset) const {
+        char* p = static_cast<char*>(dst);
+        while (bytes > 0) {
+            ssize_t got = ::pread(fd_, p, bytes, (off_t)offset);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) throw std::runtime_error("read failed on " + path_ + (got == 0 ? ": unexpected end of file" : ": " + std::string(std::strerror(errno))));
+            p += got;
+            bytes -= (std::size_t)got;
+            offset += (std::size_t)got;
+        }
+    }
+
+    void write(const void* src, std::size_t bytes, std::size_t offset) const {
+        const char* p = static_cast<const char*>(src);
+        while (bytes > 0) {
+            ssize_t put = ::pwrite(fd_, p, bytes, (off_t)offset);
+            if (put < 0 && errno == EINTR) continue;
+            if (put <= 0) throw std::runtime_error("write failed on " + path_ + ": " + std::strerror(errno));
+            p += put;
+            bytes -= (std::size_t)put;
+            offset += (std::size_t)put;
+        }
+    }
+
+    OocFile(const OocFile&) = delete;
+    OocFile& operator=(const OocFile&) = delete;
+
+private:
+    std::string path_;
+    int fd_;
+    bool unlink_;
+};
+
+class OocFftPlan {
+public:
+    // memory_budget: bytes for the slab buffers (twiddle tables and the two
+    // row plans come on top, O(sqrt(N)) each). Picks N1 close to sqrt(N).
+    OocFftPlan(std::size_t N, std::size_t memory_budget, FftDirection dir = FFT_FORWARD, int threads = 1)
+        : N_(N), threads_(threads < 1 ? 1 : threads) {
+        if (N == 0) throw std::invalid_argument("OocFftPlan: N must be positive");
+        N1_ = 1;
+        for (std::size_t n1 = 1; n1 * n1 <= N; ++n1) {
+            if (N % n1 == 0) N1_ = n1;
+        }
+        N2_ = N / N1_;
+
+        // Pass 1 slabs are N1 x w1, pass 2 slabs N2 x w2
+        std::size_t columns = memory_budget / (OOC_SLABS * sizeof(Complex));
+        w1_ = std::min(N2_, columns / N1_);
+        w2_ = std::min(N1_, columns / N2_);
+        if (w1_ == 0 || w2_ == 0) {
+            throw std::invalid_argument("OocFftPlan: memory budget below " +
+                                        std::to_string(OOC_SLABS * sizeof(Complex) * N2_) + " bytes for this N");
+        }
+        std::size_t slab = std::max(N1_ * w1_, N2_ * w2_);
+        for (int j = 0; j < 2; ++j) {
+            in_[j].resize(slab);
+            work_[j].resize(slab);
+        }
+
+        plan1_.reset(new FftPlan(N1_, dir, 1));
+        plan2_.reset(new FftPlan(N2_, dir, 1));
+
+        // W_N^e = hi_[e / split_] * lo_[e % split_], e = n2*k1 < N
+        split_ = 1;
+        while (split_ * split_ < N) split_ <<= 1;
+        lo_.resize(split_);
+        hi_.resize(N / split_ + 1);
+        for (std::size_t e = 0; e < lo_.size(); ++e) lo_[e] = unit_root<double>(dir, e, N);
+        for (std::size_t h = 0; h < hi_.size(); ++h) hi_[h] = unit_root<double>(dir, (unsigned long long)h * split_ % N, N);
+    }
+
+    std::size_t size() const { return N_; }
+    std::size_t n1() const { return N1_; }
+    std::size_t n2() const { return N2_; }
+    // Columns per slab in pass 1 and pass 2
+    std::size_t slab_width(int pass) const { return pass == 1 ? w1_ : w2_; }
+    // Bytes held in slab buffers
+    std::size_t buffer_bytes() const { return OOC_SLABS * in_[0].size() * sizeof(Complex); }
+
+    // Transform N samples at in_offset bytes into in_path, writing X at
+    // out_offset bytes into out_path (created if missing, not truncated).
+    // tmp_path holds the N2 x N1 intermediate (default out_path + ".tmp")
+    // and is removed afterwards. in_path and out_path may be the same file.
+    void execute(const std::string& in_path, const std::string& out_path, const std::string& tmp_path = "",
+                 std::size_t in_offset = 0, std::size_t out_offset = 0) const {
+        OocFile tmp(tmp_path.empty() ? out_path + ".tmp" : tmp_path, O_RDWR | O_CREAT | O_TRUNC);
+        tmp.remove_on_close();
+        {
+            OocFile in(in_path, O_RDONLY);
+            if (in.size() < in_offset + N_ * sizeof(Complex)) {
+                throw std::invalid_argument("OocFftPlan::execute: " + in_path + " holds fewer than N samples");
+            }
+            run_pass(in, in_offset, N1_, N2_, w1_, *plan1_, true, tmp, 0);
+        }
+        OocFile out(out_path, O_RDWR | O_CREAT);
+        run_pass(tmp, 0, N2_, N1_, w2_, *plan2_, false, out, out_offset);
+    }
+
+private:
+    // Column FFTs of the R x C matrix at src (length-R transforms), w columns
+    // per slab. Pass 1 (twiddle) appends each slab's rows to dst as a C x R
+    // matrix; pass 2 writes the slab back in the R x C layout.
+    void run_pass(const OocFile& src, std::size_t src_offset, std::size_t R, std::size_t C, std::size_t w,
+                  const FftPlan& plan, bool first, const OocFile& dst, std::size_t dst_offset) const {
+        const std::size_t z = sizeof(Complex);
+        std::size_t slabs = (C + w - 1) / w;
+
+        // Slab s covers columns [s*w, s*w + width(s))
+        auto read_slab = [&](std::size_t s, Complex* buf) {
+            std::size_t c0 = s * w, cw = std::min(w, C - c0);
+            if (cw == C) {
+                src.read(buf, R * C * z, src_offset);
+            } else {
+                for (std::size_t r = 0; r < R; ++r) src.read(buf + r * cw, cw * z, src_offset + (r * C + c0) * z);
+            }
+        };
+        auto write_slab = [&](std::size_t s, const Complex* buf) {
+            std::size_t c0 = s * w, cw = std::min(w, C - c0);
+            if (first || cw == C) {
+                dst.write(buf, R * cw * z, dst_offset + c0 * R * z);
+            } else {
+                for (std::size_t r = 0; r < R; ++r) dst.write(buf + r * cw, cw * z, dst_offset + (r * C + c0) * z);
+            }
+        };
+
+        std::future<void> reads[2], writes[2];
+        reads[0] = std::async(std::launch::async, read_slab, 0, in_[0].data());
+        for (std::size_t s = 0; s < slabs; ++s) {
+            int j = s & 1;
+            reads[j].get();
+            // Prefetch the next slab into the other input buffer once its last write is done
+            if (s + 1 < slabs) {
+                if (writes[j ^ 1].valid()) writes[j ^ 1].get();
+                reads[j ^ 1] = std::async(std::launch::async, read_slab, s + 1, in_[j ^ 1].data());
+            }
+
+            std::size_t c0 = s * w, cw = std::min(w, C - c0);
+            Complex* in = in_[j].data();
+            Complex* work = work_[j].data();
+            transpose_blocked(in, work, R, cw, threads_);          // cw rows of length R
+            fft_rows(plan, work, cw, threads_, scratch_);
+            if (first) {
+                twiddle(work, c0, cw);
+                writes[j] = std::async(std::launch::async, write_slab, s, work);
+            } else {
+                transpose_blocked(work, in, cw, R, threads_);
+                writes[j] = std::async(std::launch::async, write_slab, s, in);
+            }
+        }
+        for (int j = 0; j < 2; ++j) {
+            if (writes[j].valid()) writes[j].get();
+        }
+    }
+
+    // Row i of the slab is n2 = c0 + i: multiply element k1 by W_N^(n2 k1)
+    void twiddle(Complex* work, std::size_t c0, std::size_t rows) const {
+        long long count = (long long)rows;
+        #pragma omp parallel for schedule(static) num_threads(threads_) if(threads_ > 1)
+        for (long long i = 0; i < count; ++i) {
+            std::size_t n2 = c0 + (std::size_t)i;
+            Complex* row = work + (std::size_t)i * N1_;
+            for (std::size_t k1 = 1; k1 < N1_; ++k1) {
+                std::size_t e = n2 * k1;
+                Complex a = hi_[e / split_], b = lo_[e % split_];
+                // Written out: std::complex operator* carries NaN/inf recovery code
+                double wr = a.real() * b.real() - a.imag() * b.imag();
+                double wi = a.real() * b.imag() + a.imag() * b.real();
+                double xr = row[k1].real(), xi = row[k1].imag();
+                row[k1] = Complex(xr * wr - xi * wi, xr * wi + xi * wr);
+            }
+        }
+    }
+
+    std::size_t N_, N1_, N2_, w1_, w2_, split_;
+    int threads_;
+    std::unique_ptr<FftPlan> plan1_, plan2_;
+    std::vector<Complex> lo_, hi_;
+    mutable AlignedComplexVector in_[2], work_[2], scratch_;
+};
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef FFT_PRUNED_H
+#define FFT_PRUNED_H
+
+#include "fft.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// DFT of a chosen subset of output bins X[k] = sum_n x[n] exp(dir*2πikn/N).
+// Three methods, picked by a flop-count model unless one is forced:
+//
+//  - BINS_GOERTZEL: a second-order recurrence per bin,
+//        s[n] = x[n] + 2cos(2πk/N) s[n-1] - s[n-2],
+//        s[m] - w s[m-1] = sum_{n<=m} x[n] w^(n-m),  X[k] = w^(N-1) (s[N-1] - w s[N-2])
+//    (w = exp(dir*2πik/N)), 6 flops per sample per bin, vectorized across
+//    GOERTZEL_LANES bins. Best for a handful of bins. The recurrence
+//    restarts every GOERTZEL_BLOCK samples: a block [a, b) adds
+//    w^(b-1) (s[b-1] - w s[b-2]) with the exact root w^(b-1), which bounds
+//    its error growth.
+//  - BINS_PRUNED_FFT: transform decomposition. With N = P*Q and n = q*P + p,
+//        X[k] = sum_p exp(dir*2πipk/N) Y_p[k mod Q],  Y_p = FFT_Q(x[p], x[P+p], ...)
+//    so P transforms of length Q plus P multiply-adds per wanted bin:
+//    5N log2(Q) + 8PK flops instead of 5N log2(N). Q is chosen to minimize
+//    that, so a contiguous band of B bins ends up with Q near B.
+//  - BINS_FULL_FFT: the whole N-point transform, then pick the bins.
+//
+// For MPI the work is split into `parts`: part r computes its share (a block
+// of bins for Goertzel, a block of the P sub-transforms for the pruned FFT)
+// and writes zeros elsewhere, so summing the outputs of all parts
+// (MPI_Reduce with MPI_SUM) gives the result. The cost model charges each
+// part only its own share. Within a part, bins or sub-transforms are spread
+// over OpenMP threads.
+enum BinMethod { BINS_AUTO, BINS_GOERTZEL, BINS_PRUNED_FFT, BINS_FULL_FFT };
+
+const std::size_t GOERTZEL_LANES = 8;
+const std::size_t GOERTZEL_BLOCK = 256;
+const std::size_t PRUNED_ROOT_SPLIT = 1024;
+const std::size_t PRUNED_GATHER = 16;
+
+inline const char* bin_method_name(BinMethod m) {
+    switch (m) {
+    case BINS_GOERTZEL: return "goertzel";
+    case BINS_PRUNED_FFT: return "pruned FFT";
+    case BINS_FULL_FFT: return "full FFT";
+    default: return "auto";
+    }
+}
+
+// Bins k0, k0+1, ..., k0+count-1 (mod N is applied by the plan)
+inline std::vector<std::size_t> bin_range(std::size_t k0, std::size_t count) {
+    std::vector<std::size_t> bins(count);
+    for (std::size_t i = 0; i < count; ++i) bins[i] = k0 + i;
+    return bins;
+}
+
+class PrunedDftPlan {
+public:
+    PrunedDftPlan(std::size_t N, const std::vector<std::size_t>& bins, FftDirection dir = FFT_FORWARD,
+                  int threads = 1, int part = 0, int parts = 1, BinMethod method = BINS_AUTO)
+        : N_(N), dir_(dir), threads_(threads < 1 ? 1 : threads), part_(part), parts_(parts < 1 ? 1 : parts),
+          bins_(bins), Q_(N) {
+        if (N == 0) throw std::invalid_argument("PrunedDftPlan: N must be positive");
+        if (part_ < 0 || part_ >= parts_) throw std::invalid_argument("PrunedDftPlan: part out of range");
+        for (std::size_t i = 0; i < bins_.size(); ++i) bins_[i] %= N;
+
+        // Goertzel lanes run as one vector operation, so a group of
+        // GOERTZEL_LANES bins is charged like a single bin
+        std::size_t K = bins_.size();
+        std::size_t groups = ((K + parts_ - 1) / parts_ + GOERTZEL_LANES - 1) / GOERTZEL_LANES;
+        double goertzel_flops = 6.0 * N * groups;
+        double full_flops = N > 1 ? 5.0 * N * std::log2((double)N) : 1;
+        // Best Q among the proper divisors of N with only radix-2..7 factors
+        double pruned_flops = -1;
+        std::size_t best_q = N;
+        for (std::size_t q = 2; q < N; ++q) {
+            if (N % q != 0 || !smooth(q)) continue;
+            std::size_t P = N / q;
+            double share = (double)((P + parts_ - 1) / parts_);
+            double f = share * (5.0 * q * std::log2((double)q) + 8.0 * K);
+            if (pruned_flops < 0 || f < pruned_flops) {
+                pruned_flops = f;
+                best_q = q;
+            }
+        }
+
+        if (method == BINS_AUTO) {
+            method = BINS_GOERTZEL;
+            flops_ = goertzel_flops;
+            if (pruned_flops >= 0 && pruned_flops < flops_) { method = BINS_PRUNED_FFT; flops_ = pruned_flops; }
+            if (full_flops < flops_) { method = BINS_FULL_FFT; flops_ = full_flops; }
+        } else if (method == BINS_PRUNED_FFT && pruned_flops < 0) {
+            method = BINS_FULL_FFT;   // N has no usable divisor
+        }
+        method_ = method;
+        if (method_ == BINS_GOERTZEL) flops_ = goertzel_flops;
+        if (method_ == BINS_FULL_FFT) flops_ = full_flops;
+        if (method_ == BINS_PRUNED_FFT) flops_ = pruned_flops;
+
+        switch (method_) {
+        case BINS_GOERTZEL: init_goertzel(); break;
+        case BINS_PRUNED_FFT: init_pruned(best_q); break;
+        default: init_full(); break;
+        }
+    }
+
+    std::size_t size() const { return N_; }
+    const std::vector<std::size_t>& bins() const { return bins_; }
+    BinMethod method() const { return method_; }
+    // Sub-transform length of the pruned FFT (N for the full FFT)
+    std::size_t sub_size() const { return Q_; }
+    // Modelled cost of this part in flops (vector flops for Goertzel)
+    double estimated_flops() const { return flops_; }
+
+    // out[i] = X[bins[i]] (this part's contribution when parts > 1)
+    void execute(const Complex* in, Complex* out) const {
+        std::fill(out, out + bins_.size(), Complex(0));
+        switch (method_) {
+        case BINS_GOERTZEL: execute_goertzel(in, out); break;
+        case BINS_PRUNED_FFT: execute_pruned(in, out); break;
+        default:
+            if (part_ != 0) break;
+            full_->execute(in, work_.data());
+            for (std::size_t i = 0; i < bins_.size(); ++i) out[i] = work_[bins_[i]];
+            break;
+        }
+    }
+
+    void execute(const std::vector<Complex>& in, std::vector<Complex>& out) const {
+        if (in.size() != N_) throw std::invalid_argument("PrunedDftPlan::execute: input size does not match plan");
+        out.resize(bins_.size());
+        execute(in.data(), out.data());
+    }
+
+private:
+    static bool smooth(std::size_t n) {
+        for (std::size_t p = 2; p <= 7; ++p) {
+            while (n % p == 0) n /= p;
+        }
+        return n == 1;
+    }
+
+    // [begin, end) of a block split of count items into parts_
+    void my_block(std::size_t count, std::size_t& begin, std::size_t& end) const {
+        begin = count * part_ / parts_;
+        end = count * (part_ + 1) / parts_;
+    }
+
+    // exp(dir*2πie/N) = hi_[e / PRUNED_ROOT_SPLIT] * lo_[e % PRUNED_ROOT_SPLIT]: two small
+    // tables that stay in cache, where a p*k mod N walk through one N-entry
+    // table would miss on nearly every access
+    void init_roots() {
+        lo_.resize(PRUNED_ROOT_SPLIT);
+        hi_.resize(N_ / PRUNED_ROOT_SPLIT + 1);
+        for (std::size_t e = 0; e < PRUNED_ROOT_SPLIT; ++e) lo_[e] = unit_root<double>(dir_, e, N_);
+        for (std::size_t h = 0; h < hi_.size(); ++h) {
+            hi_[h] = unit_root<double>(dir_, (unsigned long long)h * PRUNED_ROOT_SPLIT % N_, N_);
+        }
+    }
+
+    Complex root(std::size_t e) const { return hi_[e / PRUNED_ROOT_SPLIT] * lo_[e % PRUNED_ROOT_SPLIT]; }
+
+    void init_goertzel() {
+        init_roots();
+        my_block(bins_.size(), b0_, b1_);
+        std::size_t K = b1_ - b0_;
+        coef_.resize(K);
+        w_.resize(K);
+        for (std::size_t i = 0; i < K; ++i) {
+            w_[i] = unit_root<double>(dir_, bins_[b0_ + i], N_);
+            coef_[i] = 2 * w_[i].real();
+        }
+    }
+
+    // Blocks of GOERTZEL_LANES bins over threads; within a block of samples
+    // the lanes share each x[n] load and run in lockstep
+    void execute_goertzel(const Complex* in, Complex* out) const {
+        const std::size_t L = GOERTZEL_LANES;
+        std::size_t K = b1_ - b0_;
+        long long groups = (long long)((K + L - 1) / L);
+        #pragma omp parallel for schedule(dynamic) num_threads(threads_) if(threads_ > 1)
+        for (long long g = 0; g < groups; ++g) {
+            std::size_t i0 = (std::size_t)g * L;
+            std::size_t lanes = std::min(L, K - i0);
+            double c[L], s1r[L], s1i[L], s2r[L], s2i[L];
+            Complex acc[L];
+            for (std::size_t l = 0; l < L; ++l) {
+                c[l] = l < lanes ? coef_[i0 + l] : 0;
+                acc[l] = 0;
+            }
+            for (std::size_t start = 0; start < N_; start += GOERTZEL_BLOCK) {
+                std::size_t end = std::min(N_, start + GOERTZEL_BLOCK);
+                for (std::size_t l = 0; l < L; ++l) s1r[l] = s1i[l] = s2r[l] = s2i[l] = 0;
+                for (std::size_t n = start; n < end; ++n) {
+                    double xr = in[n].real(), xi = in[n].imag();
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < L; ++l) {
+                        double sr = xr + c[l] * s1r[l] - s2r[l];
+                        double si = xi + c[l] * s1i[l] - s2i[l];
+                        s2r[l] = s1r[l]; s2i[l] = s1i[l];
+                        s1r[l] = sr;     s1i[l] = si;
+                    }
+                }
+                // s1 - w s2 = sum_n x[n] w^(n - (end-1)) over the block, so
+                // multiplying by the exact root w^(end-1) places it in X[k]
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    std::size_t k = bins_[b0_ + i0 + l];
+                    Complex y = Complex(s1r[l], s1i[l]) - w_[i0 + l] * Complex(s2r[l], s2i[l]);
+                    acc[l] += y * root((std::size_t)((unsigned long long)k * (end - 1) % N_));
+                }
+            }
+            for (std::size_t l = 0; l < lanes; ++l) out[b0_ + i0 + l] = acc[l];
+        }
+    }
+
+    void init_pruned(std::size_t Q) {
+        Q_ = Q;
+        std::size_t P = N_ / Q;
+        my_block(P, p0_, p1_);
+        sub_.reset(new FftPlan(Q, dir_, 1));
+        init_roots();
+        // Per thread: PRUNED_GATHER rows, sub-plan scratch, one accumulator per bin
+        work_per_thread_ = PRUNED_GATHER * Q + sub_->scratch_size() + bins_.size();
+        work_.assign(threads_ * work_per_thread_, Complex(0));
+    }
+
+    // Each thread takes a contiguous range of p, transforms PRUNED_GATHER rows
+    // at a time and folds them into its own accumulators while they are
+    // still in cache; the accumulators are summed at the end
+    void execute_pruned(const Complex* in, Complex* out) const {
+        std::size_t P = N_ / Q_, K = bins_.size();
+        std::size_t count = p1_ - p0_;
+        // The team may be smaller than threads_; only its accumulators are current
+        int team = 1;
+        #pragma omp parallel num_threads(threads_) if(threads_ > 1)
+        {
+            int tid = 0, nt = 1;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+            nt = omp_get_num_threads();
+#endif
+            if (tid == 0) team = nt;
+            Complex* rows = work_.data() + tid * work_per_thread_;
+            Complex* scratch = rows + PRUNED_GATHER * Q_;
+            Complex* acc = scratch + sub_->scratch_size();
+            std::fill(acc, acc + K, Complex(0));
+            std::size_t begin = p0_ + count * tid / nt, end = p0_ + count * (tid + 1) / nt;
+
+            for (std::size_t r0 = begin; r0 < end; r0 += PRUNED_GATHER) {
+                std::size_t r1 = std::min(end, r0 + PRUNED_GATHER);
+                // Gather rows r0..r1 so every read of in[] is a contiguous run
+                for (std::size_t q = 0; q < Q_; ++q) {
+                    const Complex* src = in + q * P;
+                    for (std::size_t r = r0; r < r1; ++r) rows[(r - r0) * Q_ + q] = src[r];
+                }
+                for (std::size_t r = r0; r < r1; ++r) {
+                    sub_->execute(rows + (r - r0) * Q_, rows + (r - r0) * Q_, scratch);
+                }
+                // X[k] += exp(dir*2πipk/N) Y_p[k mod Q]
+                for (std::size_t i = 0; i < K; ++i) {
+                    std::size_t k = bins_[i], kq = k % Q_;
+                    std::size_t pk = (std::size_t)((unsigned long long)r0 * k % N_);
+                    Complex sum = 0;
+                    for (std::size_t r = r0; r < r1; ++r) {
+                        sum += root(pk) * rows[(r - r0) * Q_ + kq];
+                        pk += k;
+                        if (pk >= N_) pk -= N_;
+                    }
+                    acc[i] += sum;
+                }
+            }
+        }
+        for (int t = 0; t < team; ++t) {
+            const Complex* acc = work_.data() + t * work_per_thread_ + PRUNED_GATHER * Q_ + sub_->scratch_size();
+            for (std::size_t i = 0; i < K; ++i) out[i] += acc[i];
+        }
+    }
+
+    void init_full() {
+        full_.reset(new FftPlan(N_, dir_, threads_));
+        work_.resize(N_);
+    }
+
+    std::size_t N_;
+    FftDirection dir_;
+    int threads_, part_, parts_;
+    std::vector<std::size_t> bins_;
+    BinMethod method_;
+    double flops_;
+    std::size_t Q_;
+    // Goertzel: this part's bins [b0_, b1_)
+    std::size_t b0_ = 0, b1_ = 0;
+    std::vector<double> coef_;
+    std::vector<Complex> w_;
+    // Pruned FFT: this part's sub-transforms [p0_, p1_)
+    std::size_t p0_ = 0, p1_ = 0, work_per_thread_ = 0;
+    std::unique_ptr<FftPlan> sub_, full_;
+    AlignedComplexVector lo_, hi_;
+    mutable AlignedComplexVector work_;
+};
+
+#endif
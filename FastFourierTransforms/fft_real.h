@@ -0,0 +1,116 @@
+#ifndef FFT_REAL_H
+#define FFT_REAL_H
+
+#include "fft.h"
+
+// Real-to-complex (r2c) and complex-to-real (c2r) transforms.
+// The spectrum of real data is Hermitian (X_{N-k} = conj(X_k)), so only the
+// N/2+1 bins X_0..X_{N/2} are stored. For even N the N reals are packed as
+// N/2 complex values z_n = x_{2n} + i x_{2n+1}, transformed with one N/2-point
+// complex FFT and then split into the even/odd spectra:
+//   E_k = (Z_k + conj(Z_{N/2-k})) / 2,  O_k = (Z_k - conj(Z_{N/2-k})) / 2i
+//   X_k = E_k + exp(-2πik/N) O_k
+// c2r runs the same steps backwards. Odd N falls back to a full N-point
+// complex FFT. Like FFT_BACKWARD, c2r is unnormalized: c2r(r2c(x)) = N * x.
+//
+// Templated on the scalar type like FftPlanT; RealFftPlan is the double plan.
+template <typename Real>
+class RealFftPlanT {
+public:
+    typedef Real real_type;
+    typedef std::complex<Real> complex_type;
+
+    RealFftPlanT(std::size_t N, int threads = 1)
+        : N_(N), odd_(N % 2 == 1),
+          plan_(odd_ ? N : N / 2, FFT_FORWARD, threads),
+          work_(plan_.size()), scratch_(plan_.scratch_size()) {
+        if (!odd_) {
+            w_.resize(N / 2 + 1);
+            for (std::size_t k = 0; k <= N / 2; ++k) w_[k] = unit_root<Real>(-1, k, N);
+        }
+    }
+
+    std::size_t size() const { return N_; }
+
+    // Number of complex bins produced by r2c / consumed by c2r
+    std::size_t spectrum_size() const { return N_ / 2 + 1; }
+
+    // out[0..N/2] = FFT(in[0..N-1])
+    void r2c(const Real* in, complex_type* out) const {
+        complex_type* z = work_.data();
+        if (odd_) {
+            for (std::size_t n = 0; n < N_; ++n) z[n] = in[n];
+            plan_.execute(z, z, scratch_.data());
+            std::copy(z, z + spectrum_size(), out);
+            return;
+        }
+        std::size_t H = N_ / 2;
+        for (std::size_t n = 0; n < H; ++n) z[n] = complex_type(in[2 * n], in[2 * n + 1]);
+        plan_.execute(z, z, scratch_.data());
+
+        for (std::size_t k = 0; k <= H; ++k) {
+            complex_type zk = z[k < H ? k : 0];
+            complex_type zc = std::conj(z[k > 0 ? H - k : 0]);
+            complex_type e = Real(0.5) * (zk + zc);
+            complex_type d = Real(0.5) * (zk - zc);
+            complex_type o(d.imag(), -d.real());   // d / i
+            out[k] = e + w_[k] * o;
+        }
+    }
+
+    // out[0..N-1] = unnormalized inverse FFT of the Hermitian spectrum in[0..N/2]
+    void c2r(const complex_type* in, Real* out) const {
+        complex_type* z = work_.data();
+        if (odd_) {
+            // Rebuild the full spectrum, then backward FFT as conj(FFT(conj(.)))
+            z[0] = std::conj(in[0]);
+            for (std::size_t k = 1; k < spectrum_size(); ++k) {
+                z[k] = std::conj(in[k]);
+                z[N_ - k] = in[k];
+            }
+            plan_.execute(z, z, scratch_.data());
+            for (std::size_t n = 0; n < N_; ++n) out[n] = z[n].real();
+            return;
+        }
+        std::size_t H = N_ / 2;
+        // Z_k = E_k + i O_k with E, O scaled by 2 so the result matches the
+        // N-point unnormalized inverse; stored conjugated for the forward plan
+        for (std::size_t k = 0; k < H; ++k) {
+            complex_type xk = in[k];
+            complex_type xc = std::conj(in[H - k]);
+            complex_type e = xk + xc;
+            complex_type o = (xk - xc) * std::conj(w_[k]);
+            z[k] = std::conj(e + complex_type(-o.imag(), o.real()));
+        }
+        plan_.execute(z, z, scratch_.data());
+        for (std::size_t n = 0; n < H; ++n) {
+            out[2 * n] = z[n].real();
+            out[2 * n + 1] = -z[n].imag();
+        }
+    }
+
+    void r2c(const std::vector<Real>& in, std::vector<complex_type>& out) const {
+        if (in.size() != N_) throw std::invalid_argument("RealFftPlanT::r2c: input size does not match plan");
+        out.resize(spectrum_size());
+        r2c(in.data(), out.data());
+    }
+
+    void c2r(const std::vector<complex_type>& in, std::vector<Real>& out) const {
+        if (in.size() != spectrum_size()) throw std::invalid_argument("RealFftPlanT::c2r: input size does not match plan");
+        out.resize(N_);
+        c2r(in.data(), out.data());
+    }
+
+private:
+    std::size_t N_;
+    bool odd_;
+    FftPlanT<Real> plan_;
+    AlignedVector<complex_type> w_;
+    mutable AlignedVector<complex_type> work_, scratch_;
+};
+
+typedef RealFftPlanT<float> RealFftPlanF;
+typedef RealFftPlanT<double> RealFftPlan;
+typedef RealFftPlanT<long double> RealFftPlanL;
+
+#endif
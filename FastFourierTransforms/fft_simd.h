@@ -0,0 +1,187 @@
+#ifndef FFT_SIMD_H
+#define FFT_SIMD_H
+
+#include <cstring>
+#include <cstdlib>
+#include "fft.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FFT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Split-complex (structure of arrays) radix-2 FFT.
+// Real and imaginary parts live in separate arrays, so one vector register
+// holds W real parts (or W imaginary parts) and a butterfly is a handful of
+// plain vector multiplies/adds with no shuffles. Each stage of length len
+// reads its twiddles contiguously from wr/wi[len/2 .. len-1].
+//
+// On x86 the SSE2, AVX2+FMA and AVX-512 kernels are all compiled into the
+// same binary (per-function target attributes) and the widest one the CPU
+// supports is chosen at run time. Other architectures (e.g. Apple M1) use
+// the portable kernel, which the compiler vectorizes for the native ISA.
+// Set FFT_SIMD=scalar|sse2|avx2|avx512 to force a kernel.
+
+// One butterfly stage over all blocks of length 2*half; wr/wi hold that stage's half twiddles
+typedef void (*SplitStageKernel)(double* re, double* im, const double* wr, const double* wi,
+                                 std::size_t N, std::size_t half);
+
+inline void split_stage_scalar(double* re, double* im, const double* wr, const double* wi,
+                               std::size_t N, std::size_t half) {
+    for (std::size_t start = 0; start < N; start += 2 * half) {
+        double* ar = re + start; double* ai = im + start;
+        double* br = ar + half;  double* bi = ai + half;
+        for (std::size_t j = 0; j < half; ++j) {
+            double tr = wr[j] * br[j] - wi[j] * bi[j];
+            double ti = wr[j] * bi[j] + wi[j] * br[j];
+            br[j] = ar[j] - tr; bi[j] = ai[j] - ti;
+            ar[j] += tr;        ai[j] += ti;
+        }
+    }
+}
+
+#ifdef FFT_SIMD_X86
+// half >= 2
+__attribute__((target("sse2")))
+inline void split_stage_sse2(double* re, double* im, const double* wr, const double* wi,
+                             std::size_t N, std::size_t half) {
+    for (std::size_t start = 0; start < N; start += 2 * half) {
+        double* ar = re + start; double* ai = im + start;
+        double* br = ar + half;  double* bi = ai + half;
+        for (std::size_t j = 0; j < half; j += 2) {
+            __m128d vwr = _mm_loadu_pd(wr + j), vwi = _mm_loadu_pd(wi + j);
+            __m128d vbr = _mm_loadu_pd(br + j), vbi = _mm_loadu_pd(bi + j);
+            __m128d var = _mm_loadu_pd(ar + j), vai = _mm_loadu_pd(ai + j);
+            __m128d tr = _mm_sub_pd(_mm_mul_pd(vwr, vbr), _mm_mul_pd(vwi, vbi));
+            __m128d ti = _mm_add_pd(_mm_mul_pd(vwr, vbi), _mm_mul_pd(vwi, vbr));
+            _mm_storeu_pd(br + j, _mm_sub_pd(var, tr)); _mm_storeu_pd(bi + j, _mm_sub_pd(vai, ti));
+            _mm_storeu_pd(ar + j, _mm_add_pd(var, tr)); _mm_storeu_pd(ai + j, _mm_add_pd(vai, ti));
+        }
+    }
+}
+
+// half >= 4
+__attribute__((target("avx2,fma")))
+inline void split_stage_avx2(double* re, double* im, const double* wr, const double* wi,
+                             std::size_t N, std::size_t half) {
+    for (std::size_t start = 0; start < N; start += 2 * half) {
+        double* ar = re + start; double* ai = im + start;
+        double* br = ar + half;  double* bi = ai + half;
+        for (std::size_t j = 0; j < half; j += 4) {
+            __m256d vwr = _mm256_loadu_pd(wr + j), vwi = _mm256_loadu_pd(wi + j);
+            __m256d vbr = _mm256_loadu_pd(br + j), vbi = _mm256_loadu_pd(bi + j);
+            __m256d var = _mm256_loadu_pd(ar + j), vai = _mm256_loadu_pd(ai + j);
+            __m256d tr = _mm256_fmsub_pd(vwr, vbr, _mm256_mul_pd(vwi, vbi));
+            __m256d ti = _mm256_fmadd_pd(vwr, vbi, _mm256_mul_pd(vwi, vbr));
+            _mm256_storeu_pd(br + j, _mm256_sub_pd(var, tr)); _mm256_storeu_pd(bi + j, _mm256_sub_pd(vai, ti));
+            _mm256_storeu_pd(ar + j, _mm256_add_pd(var, tr)); _mm256_storeu_pd(ai + j, _mm256_add_pd(vai, ti));
+        }
+    }
+}
+
+// half >= 8
+__attribute__((target("avx512f")))
+inline void split_stage_avx512(double* re, double* im, const double* wr, const double* wi,
+                               std::size_t N, std::size_t half) {
+    for (std::size_t start = 0; start < N; start += 2 * half) {
+        double* ar = re + start; double* ai = im + start;
+        double* br = ar + half;  double* bi = ai + half;
+        for (std::size_t j = 0; j < half; j += 8) {
+            __m512d vwr = _mm512_loadu_pd(wr + j), vwi = _mm512_loadu_pd(wi + j);
+            __m512d vbr = _mm512_loadu_pd(br + j), vbi = _mm512_loadu_pd(bi + j);
+            __m512d var = _mm512_loadu_pd(ar + j), vai = _mm512_loadu_pd(ai + j);
+            __m512d tr = _mm512_fmsub_pd(vwr, vbr, _mm512_mul_pd(vwi, vbi));
+            __m512d ti = _mm512_fmadd_pd(vwr, vbi, _mm512_mul_pd(vwi, vbr));
+            _mm512_storeu_pd(br + j, _mm512_sub_pd(var, tr)); _mm512_storeu_pd(bi + j, _mm512_sub_pd(vai, ti));
+            _mm512_storeu_pd(ar + j, _mm512_add_pd(var, tr)); _mm512_storeu_pd(ai + j, _mm512_add_pd(vai, ti));
+        }
+    }
+}
+#endif
+
+// Kernel chosen once per process from CPUID (or the FFT_SIMD override)
+struct SplitKernel {
+    const char* name;
+    SplitStageKernel stage;
+    std::size_t width;   // doubles per vector; stages with half < width run scalar
+};
+
+inline SplitKernel select_split_kernel() {
+    SplitKernel scalar = { "scalar", split_stage_scalar, 1 };
+#ifdef FFT_SIMD_X86
+    SplitKernel sse2 = { "sse2", split_stage_sse2, 2 };
+    SplitKernel avx2 = { "avx2", split_stage_avx2, 4 };
+    SplitKernel avx512 = { "avx512", split_stage_avx512, 8 };
+    __builtin_cpu_init();
+    bool has_sse2 = __builtin_cpu_supports("sse2");
+    bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    bool has_avx512 = __builtin_cpu_supports("avx512f");
+
+    const char* force = std::getenv("FFT_SIMD");
+    if (force) {
+        if (!std::strcmp(force, "scalar")) return scalar;
+        if (!std::strcmp(force, "sse2") && has_sse2) return sse2;
+        if (!std::strcmp(force, "avx2") && has_avx2) return avx2;
+        if (!std::strcmp(force, "avx512") && has_avx512) return avx512;
+    }
+    if (has_avx512) return avx512;
+    if (has_avx2) return avx2;
+    if (has_sse2) return sse2;
+#endif
+    return scalar;
+}
+
+inline const SplitKernel& split_kernel() {
+    static const SplitKernel k = select_split_kernel();
+    return k;
+}
+
+// AoS <-> SoA conversion for callers holding std::complex data
+inline void split_complex(const Complex* in, double* re, double* im, std::size_t N) {
+    for (std::size_t i = 0; i < N; ++i) { re[i] = in[i].real(); im[i] = in[i].imag(); }
+}
+
+inline void interleave_complex(const double* re, const double* im, Complex* out, std::size_t N) {
+    for (std::size_t i = 0; i < N; ++i) out[i] = Complex(re[i], im[i]);
+}
+
+// In-place split-complex radix-2 FFT plan (N must be a power of two)
+class SplitFftPlan {
+public:
+    SplitFftPlan(std::size_t N, FftDirection dir = FFT_FORWARD)
+        : N_(N), rev_(make_bitrev(N)), wr_(N), wi_(N), kernel_(split_kernel()) {
+        if (N == 0 || (N & (N - 1)) != 0) {
+            throw std::invalid_argument("SplitFftPlan: N must be a power of two");
+        }
+        // Stage twiddles stored contiguously: wr/wi[half + j] = exp(dir*2πij/(2*half))
+        for (std::size_t half = 1; half < N; half <<= 1) {
+            for (std::size_t j = 0; j < half; ++j) {
+                Complex w = std::polar(1.0, dir * PI * j / half);
+                wr_[half + j] = w.real();
+                wi_[half + j] = w.imag();
+            }
+        }
+    }
+
+    std::size_t size() const { return N_; }
+    const char* kernel_name() const { return kernel_.name; }
+
+    void execute(double* re, double* im) const {
+        for (std::size_t i = 0; i < N_; ++i) {
+            std::size_t r = rev_[i];
+            if (i < r) { std::swap(re[i], re[r]); std::swap(im[i], im[r]); }
+        }
+        for (std::size_t half = 1; half < N_; half <<= 1) {
+            SplitStageKernel stage = half >= kernel_.width ? kernel_.stage : split_stage_scalar;
+            stage(re, im, wr_.data() + half, wi_.data() + half, N_, half);
+        }
+    }
+
+private:
+    std::size_t N_;
+    std::vector<std::size_t> rev_;
+    std::vector<double, AlignedAllocator<double> > wr_, wi_;
+    SplitKernel kernel_;
+};
+
+#endif
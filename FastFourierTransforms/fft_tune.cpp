@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include "fft.h"
+#include "fft_wisdom.h"
+
+using namespace std;
+
+// Auto-tunes FFT plans and persists the winners as wisdom.
+// Usage: ./fft_tune [-t threads] [-w wisdom_file] [-f] N [N ...]
+//   -f re-measures sizes that already have wisdom
+int main(int argc, char** argv) {
+    int threads = 1;
+    bool force = false;
+    string path = default_wisdom_path();
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "-w" && i + 1 < argc) path = argv[++i];
+        else if (arg == "-f") force = true;
+        else {
+            char* end;
+            size_t N = strtoul(argv[i], &end, 10);
+            if (N == 0 || *end != '\0' || arg[0] == '-') {
+                cerr << "Usage: " << argv[0] << " [-t threads] [-w wisdom_file] [-f] N [N ...]" << endl;
+                return 1;
+            }
+            sizes.push_back(N);
+        }
+    }
+    if (sizes.empty()) sizes = {1024, 1536, 65536, 1 << 20};
+
+    FftWisdom wisdom(path);
+    cout << "Wisdom file: " << wisdom.path() << " (" << wisdom.size() << " entries)" << endl;
+
+    for (size_t N : sizes) {
+        FftVariant known;
+        if (!force && wisdom.find(precision_name<double>(), N, threads, known)) {
+            // Startup with wisdom: no measurement, just build the plan
+            auto t0 = chrono::steady_clock::now();
+            FftPlan plan = plan_fft<double>(N, FFT_FORWARD, threads, wisdom);
+            double setup = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            cout << "N = " << N << ": " << algorithm_name(plan.algorithm())
+                 << " from wisdom, plan built in " << setup * 1e3 << " ms" << endl;
+            continue;
+        }
+        cout << "N = " << N << ", " << threads << " thread(s):" << endl;
+        WisdomEntry best = tune_fft<double>(N, threads, &cout);
+        wisdom.put(best);
+        cout << "  -> " << algorithm_name(best.variant.algorithm);
+        if (best.variant.algorithm == FFT_STOCKHAM) cout << " radix-" << best.variant.radix;
+        if (best.variant.algorithm == FFT_RECURSIVE) cout << " leaf " << best.variant.leaf;
+        cout << endl;
+    }
+
+    if (!wisdom.save()) {
+        cerr << "Cannot write " << wisdom.path() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+#ifndef FFT_WISDOM_H
+#define FFT_WISDOM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "fft.h"
+
+// Auto-tuning planner with persistent "wisdom".
+// tune_fft() times every applicable FftVariant for one size, precision and
+// thread count on this machine (iterative radix-2, small-N codelets,
+// Stockham radix-4 and radix-2, recursive with several leaf sizes,
+// Bluestein) and returns the fastest. The winner is stored in a wisdom
+// file, one line per entry:
+//     <precision> <N> <threads> <algorithm> <radix> <leaf> <seconds>
+// so plan_fft() on a later run reads it back and builds the best plan
+// without measuring anything.
+
+template <typename Real> inline const char* precision_name();
+template <> inline const char* precision_name<float>() { return "float"; }
+template <> inline const char* precision_name<double>() { return "double"; }
+template <> inline const char* precision_name<long double>() { return "long_double"; }
+
+inline const char* algorithm_name(FftAlgorithm a) {
+    switch (a) {
+    case FFT_RADIX2: return "radix2";
+    case FFT_STOCKHAM: return "stockham";
+    case FFT_BLUESTEIN: return "bluestein";
+    case FFT_RECURSIVE: return "recursive";
+    case FFT_CODELET: return "codelet";
+    default: return "auto";
+    }
+}
+
+inline FftAlgorithm parse_algorithm(const std::string& name) {
+    if (name == "radix2") return FFT_RADIX2;
+    if (name == "stockham") return FFT_STOCKHAM;
+    if (name == "bluestein") return FFT_BLUESTEIN;
+    if (name == "recursive") return FFT_RECURSIVE;
+    if (name == "codelet") return FFT_CODELET;
+    return FFT_AUTO;
+}
+
+// $FFT_WISDOM if set, otherwise fft_wisdom.txt in the working directory
+inline std::string default_wisdom_path() {
+    const char* env = std::getenv("FFT_WISDOM");
+    return env ? env : "fft_wisdom.txt";
+}
+
+struct WisdomEntry {
+    std::string precision;
+    std::size_t N;
+    int threads;
+    FftVariant variant;
+    double seconds;
+};
+
+class FftWisdom {
+public:
+    explicit FftWisdom(const std::string& path = default_wisdom_path()) : path_(path) { load(); }
+
+    const std::string& path() const { return path_; }
+    std::size_t size() const { return entries_.size(); }
+
+    bool find(const std::string& precision, std::size_t N, int threads, FftVariant& variant) const {
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const WisdomEntry& e = entries_[i];
+            if (e.precision == precision && e.N == N && e.threads == threads) {
+                variant = e.variant;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Adds or replaces the entry for (precision, N, threads)
+    void put(const WisdomEntry& entry) {
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            WisdomEntry& e = entries_[i];
+            if (e.precision == entry.precision && e.N == entry.N && e.threads == entry.threads) {
+                e = entry;
+                return;
+            }
+        }
+        entries_.push_back(entry);
+    }
+
+    bool save() const {
+        std::ofstream out(path_.c_str());
+        if (!out) return false;
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const WisdomEntry& e = entries_[i];
+            out << e.precision << " " << e.N << " " << e.threads << " "
+                << algorithm_name(e.variant.algorithm) << " " << e.variant.radix << " "
+                << e.variant.leaf << " " << e.seconds << "\n";
+        }
+        return bool(out);
+    }
+
+private:
+    // Missing file means no wisdom yet; malformed lines are skipped
+    void load() {
+        std::ifstream in(path_.c_str());
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ss(line);
+            WisdomEntry e;
+            std::string algo;
+            if (ss >> e.precision >> e.N >> e.threads >> algo >> e.variant.radix >> e.variant.leaf >> e.seconds) {
+                e.variant.algorithm = parse_algorithm(algo);
+                if (e.variant.algorithm != FFT_AUTO) entries_.push_back(e);
+            }
+        }
+    }
+
+    std::string path_;
+    std::vector<WisdomEntry> entries_;
+};
+
+// Variants worth timing for N; forced variants that do not apply to N are left out
+inline std::vector<FftVariant> fft_candidates(std::size_t N) {
+    if (N == 0) throw std::invalid_argument("fft_candidates: N must be positive");
+    std::vector<FftVariant> c;
+    bool pow2 = (N & (N - 1)) == 0;
+    std::size_t n = N;
+    for (int p = 2; p <= 7; ++p) {
+        while (n % p == 0) n /= p;
+    }
+    bool smooth = n == 1;
+
+    if (pow2) {
+        c.push_back(FftVariant(FFT_RADIX2));
+        if (N <= FFT_CODELET_MAX) c.push_back(FftVariant(FFT_CODELET));
+        const std::size_t leaves[] = { 32, 64, 256, 1024, 4096, 16384 };
+        for (std::size_t i = 0; i < 6; ++i) {
+            if (leaves[i] < N) c.push_back(FftVariant(FFT_RECURSIVE, 2, leaves[i]));
+        }
+    }
+    if (smooth) {
+        c.push_back(FftVariant(FFT_STOCKHAM, 4));
+        if (N % 4 == 0) c.push_back(FftVariant(FFT_STOCKHAM, 2));
+    } else {
+        c.push_back(FftVariant(FFT_BLUESTEIN));
+    }
+    return c;
+}
+
+// Median time of one execute(), measured over 5 batches of ~min_seconds/5
+template <typename Real>
+inline double time_plan(const FftPlanT<Real>& plan, double min_seconds = 0.05) {
+    typedef std::chrono::steady_clock clock;
+    std::vector<std::complex<Real> > in(plan.size(), std::complex<Real>(1, 0)), out(plan.size());
+    plan.execute(in.data(), out.data());   // warm-up
+
+    // Calibrate repetitions per batch
+    int reps = 1;
+    while (true) {
+        clock::time_point t0 = clock::now();
+        for (int r = 0; r < reps; ++r) plan.execute(in.data(), out.data());
+        double s = std::chrono::duration<double>(clock::now() - t0).count();
+        if (s >= min_seconds / 5 || reps >= (1 << 20)) break;
+        reps *= 2;
+    }
+    std::vector<double> samples;
+    for (int b = 0; b < 5; ++b) {
+        clock::time_point t0 = clock::now();
+        for (int r = 0; r < reps; ++r) plan.execute(in.data(), out.data());
+        samples.push_back(std::chrono::duration<double>(clock::now() - t0).count() / reps);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[2];
+}
+
+// Times every candidate and returns the fastest; with report set, prints each timing
+template <typename Real>
+inline WisdomEntry tune_fft(std::size_t N, int threads, std::ostream* report = 0) {
+    WisdomEntry best;
+    best.precision = precision_name<Real>();
+    best.N = N;
+    best.threads = threads;
+    best.seconds = -1;
+    std::vector<FftVariant> candidates = fft_candidates(N);
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        FftPlanT<Real> plan(N, FFT_FORWARD, threads, candidates[i]);
+        double t = time_plan(plan);
+        if (report) {
+            *report << "  " << algorithm_name(candidates[i].algorithm);
+            if (candidates[i].algorithm == FFT_STOCKHAM) *report << " radix-" << candidates[i].radix;
+            if (candidates[i].algorithm == FFT_RECURSIVE) *report << " leaf " << candidates[i].leaf;
+            *report << ": " << t * 1e6 << " us\n";
+        }
+        if (best.seconds < 0 || t < best.seconds) {
+            best.seconds = t;
+            best.variant = candidates[i];
+        }
+    }
+    return best;
+}
+
+// Builds the best known plan: from wisdom if present, otherwise tunes,
+// records the winner and saves the wisdom file
+template <typename Real>
+inline FftPlanT<Real> plan_fft(std::size_t N, FftDirection dir, int threads, FftWisdom& wisdom) {
+    FftVariant variant;
+    if (!wisdom.find(precision_name<Real>(), N, threads, variant)) {
+        WisdomEntry best = tune_fft<Real>(N, threads);
+        wisdom.put(best);
+        wisdom.save();
+        variant = best.variant;
+    }
+    return FftPlanT<Real>(N, dir, threads, variant);
+}
+
+#endif
@@ -2,12 +2,32 @@
 #include <complex>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <string>
+#include <sstream>
 #include <mpi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "fft_pruned.h"
 
 using namespace std;
 
-typedef complex<double> Complex;
-const double PI = acos(-1);
+// "k0:k1" is the range k0 .. k1-1, "a,b,c" a list; empty means all N bins
+vector<size_t> parse_bins(const string& spec, size_t N) {
+    if (spec.empty()) return bin_range(0, N);
+    size_t colon = spec.find(':');
+    if (colon != string::npos) {
+        size_t k0 = strtoull(spec.substr(0, colon).c_str(), 0, 10);
+        size_t k1 = strtoull(spec.substr(colon + 1).c_str(), 0, 10);
+        return bin_range(k0, k1 > k0 ? k1 - k0 : 0);
+    }
+    vector<size_t> bins;
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) bins.push_back(strtoull(item.c_str(), 0, 10));
+    return bins;
+}
 
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
@@ -16,13 +36,20 @@ int main(int argc, char** argv) {
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    int N = 8;  // Example size
+    // Usage: mpi_DFT [N] [bins] [threads per rank]
+    int N = argc > 1 ? atoi(argv[1]) : 8;  // Example size
+    vector<size_t> bins = parse_bins(argc > 2 ? argv[2] : "", N);
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+#ifdef _OPENMP
+    if (argc <= 3) threads = omp_get_max_threads();
+#endif
     vector<Complex> x(N);
 
     // Rank 0 initializes the input data
     if (rank == 0) {
         for (int i = 0; i < N; i++) {
             x[i] = sin(2 * PI * i / N);
+            if (N > 16) x[i] += 0.5 * cos(2 * PI * 1001.25 * i / N);   // plus an off-bin tone
         }
     }
 
@@ -30,46 +57,49 @@ int main(int argc, char** argv) {
     MPI_Bcast(x.data(), 2*N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     // Note: each complex<double> = 2 doubles
 
-    // Each process does its share
-    int k_per_proc = N / size;
-    int k_start = rank * k_per_proc;
-    int k_end = (rank == size - 1) ? N : k_start + k_per_proc;
+    // Each process computes its share of the requested bins (Goertzel) or of
+    // the sub-transforms (pruned FFT); the shares add up to the DFT
+    PrunedDftPlan plan(N, bins, FFT_FORWARD, threads, rank, size);
+    vector<Complex> local_X(bins.size());
 
-    vector<Complex> local_X(k_end - k_start);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    plan.execute(x.data(), local_X.data());
 
-    for (int k = k_start; k < k_end; ++k) {
-        Complex sum = 0;
-        for (int n = 0; n < N; ++n) {
-            double angle = -2 * PI * k * n / N;
-            sum += x[n] * Complex(cos(angle), sin(angle));
-        }
-        local_X[k - k_start] = sum;
-    }
-
-    // Gather results on rank 0
-    vector<Complex> X(N);
-    vector<int> recvcounts(size);
-    vector<int> displs(size);
-
-    for (int i = 0; i < size; ++i) {
-        int start = i * k_per_proc;
-        int end = (i == size - 1) ? N : start + k_per_proc;
-        recvcounts[i] = (end - start) * 2; // complex = 2 doubles
-        displs[i] = start * 2;
-    }
-
-    MPI_Gatherv(local_X.data(), (k_end - k_start)*2, MPI_DOUBLE,
-                X.data(), recvcounts.data(), displs.data(),
-                MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // Sum the shares on rank 0
+    vector<Complex> X(bins.size());
+    MPI_Reduce(local_X.data(), X.data(), 2 * (int)bins.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    double elapsed = MPI_Wtime() - t0;
 
     if (rank == 0) {
-        cout << "Input:\n";
-        for (auto val : x) cout << val << endl;
-
-        cout << "\nDFT Output:\n";
-        for (auto val : X) cout << val << endl;
+        if (N <= 16) {
+            cout << "Input:\n";
+            for (auto val : x) cout << val << endl;
+
+            cout << "\nDFT Output:\n";
+            for (auto val : X) cout << val << endl;
+        } else {
+            cout << "N = " << N << ", " << bins.size() << " bins, " << size << " rank(s) x "
+                 << threads << " thread(s)\n";
+            cout << "Method: " << bin_method_name(plan.method());
+            if (plan.method() == BINS_PRUNED_FFT) cout << " (" << N / plan.sub_size() << " x " << plan.sub_size() << ")";
+            cout << "\nTime: " << elapsed << " seconds\n";
+            for (size_t i = 0; i < bins.size() && i < 8; ++i) cout << "X[" << bins[i] << "] = " << X[i] << endl;
+
+            if (N <= (1 << 22)) {
+                FftPlan full(N);
+                vector<Complex> ref;
+                full.execute(x, ref);
+                double err = 0, norm = 0;
+                for (size_t i = 0; i < bins.size(); ++i) {
+                    err = max(err, abs(X[i] - ref[bins[i] % N]));
+                    norm = max(norm, abs(ref[bins[i] % N]));
+                }
+                cout << "Max relative error vs full FFT: " << (norm > 0 ? err / norm : err) << endl;
+            }
+        }
     }
 
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
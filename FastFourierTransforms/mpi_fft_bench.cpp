@@ -0,0 +1,106 @@
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <mpi.h>
+#include "fft.h"
+#include "fft_mpi.h"
+#include "fft_bench.h"
+
+using namespace std;
+
+// The MPI variant of fft_bench: MpiFftPlan over all ranks for N = 2^min ..
+// 2^max (sizes not divisible by ranks^2 are skipped) and each thread count
+// per rank. Same columns, CSV and JSON as fft_bench, written by rank 0.
+// Usage: mpirun -np P ./mpi_fft_bench [--min 4] [--max 26] [-t 1,2] [--samples 7]
+//                                     [--csv file] [--json file] [--tag name]
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int min_log = 4, max_log = 26, samples = 7;
+    string csv, json, tag = "untagged";
+    vector<int> threads = {1};
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--min" && i + 1 < argc) min_log = atoi(argv[++i]);
+        else if (arg == "--max" && i + 1 < argc) max_log = atoi(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc) threads = parse_int_list(argv[++i]);
+        else if (arg == "--samples" && i + 1 < argc) samples = atoi(argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc) csv = argv[++i];
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else if (arg == "--tag" && i + 1 < argc) tag = argv[++i];
+        else {
+            if (rank == 0) {
+                cerr << "Usage: " << argv[0] << " [--min log2N] [--max log2N] [-t threads,...] [--samples n]"
+                     << " [--csv file] [--json file] [--tag name]" << endl;
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    // Every rank has to agree on the repeat counts: time by the slowest rank
+    auto slowest = [](double t) {
+        double m;
+        MPI_Allreduce(&t, &m, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        return m;
+    };
+
+    unique_ptr<BenchReport> report;
+    if (rank == 0) report.reset(new BenchReport(tag, csv, json));
+    for (int lg = min_log; lg <= max_log; ++lg) {
+        size_t N = size_t(1) << lg;
+        if (N % ((size_t)size * size) != 0) continue;
+
+        for (int t : threads) {
+            MpiFftPlan plan(N, MPI_COMM_WORLD, FFT_FORWARD, t);
+            size_t local_n = plan.local_size(), start = plan.local_start();
+            vector<Complex> x(local_n), X(local_n);
+
+            // Random input checked on rank 0 against the long double FFT, or
+            // tones checked block by block against their exact spectrum
+            long double err2 = 0, ref2 = 0;
+            bool exact = bench_exact_reference(N);
+            if (exact) {
+                ToneSignal tones(N);
+                tones.generate(x.data(), start, local_n);
+                plan.execute(x.data(), X.data());
+                long double local[2] = { 0, 0 }, total[2];
+                tones.accumulate_error(X.data(), start, local_n, local[0], local[1]);
+                MPI_Reduce(local, total, 2, MPI_LONG_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+                err2 = total[0];
+                ref2 = total[1];
+            } else {
+                random_signal(x.data(), start, local_n);
+                plan.execute(x.data(), X.data());
+                vector<Complex> X_all(rank == 0 ? N : 0);
+                MPI_Gather(X.data(), (int)(2 * local_n), MPI_DOUBLE, X_all.data(), (int)(2 * local_n), MPI_DOUBLE,
+                           0, MPI_COMM_WORLD);
+                if (rank == 0) accumulate_error(X_all.data(), reference_spectrum(N).data(), N, err2, ref2);
+            }
+
+            BenchResult r;
+            time_median([&] { plan.execute(x.data(), X.data()); }, samples, r.median, r.best, slowest);
+            if (rank == 0) {
+                r.variant = "mpi";
+                r.algorithm = "six-step";
+                r.N = N;
+                r.ranks = size;
+                r.threads = t;
+                r.gflops = 5.0 * N * lg / r.median * 1e-9;
+                r.error = (double)sqrtl(err2 / ref2);
+                r.reference = exact ? "exact_tones" : "long_double";
+                report->add(r);
+            }
+        }
+    }
+    if (rank == 0) report->finish();
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,241 @@
+#ifndef NTT_H
+#define NTT_H
+
+#include <cstdint>
+#include "fft.h"
+
+// Number-theoretic transform: the radix-2 FFT over the integers mod a prime
+// p = c*2^k + 1 instead of the complex numbers. Z/p has primitive 2^k-th
+// roots of unity, so the same bit reversal and butterfly_stages() from
+// fft.h apply with modular +, - and *, and convolutions come out exact
+// (mod p) with no rounding at all.
+//
+// Exact integer convolution runs the NTT under up to three primes and
+// rebuilds each coefficient with the Chinese remainder theorem (Garner's
+// method); the number of primes is picked from a bound on the result.
+// bigint_multiply() builds big-integer multiplication on top of it.
+
+// NTT-friendly primes c*2^k + 1 < 2^30, all with primitive root 3
+const std::uint32_t NTT_P1 = 998244353;   // 119 * 2^23 + 1
+const std::uint32_t NTT_P2 = 167772161;   //   5 * 2^25 + 1
+const std::uint32_t NTT_P3 = 469762049;   //   7 * 2^26 + 1
+const std::uint32_t NTT_ROOT = 3;
+// Longest transform all three primes support
+const std::size_t NTT_MAX_SIZE = std::size_t(1) << 23;
+
+// Integer mod P in Montgomery form: v = x * 2^32 mod P. A product then needs
+// one 32x32 multiply to find the multiple of P that clears the low word
+// instead of a 64-bit division, and every step is on 32-bit lanes, so the
+// butterfly loops vectorize. P < 2^30 keeps sums below 2^32 and the
+// reduction input below 2^64.
+template <std::uint32_t P>
+struct ModP {
+    std::uint32_t v;
+
+    ModP() : v(0) {}
+    explicit ModP(std::uint64_t x) : v(reduce((x % P) * R2)) {}
+
+    // Ordinary residue in [0, P)
+    std::uint32_t value() const { return reduce(v); }
+
+    friend ModP operator+(ModP a, ModP b) {
+        std::uint32_t s = a.v + b.v;
+        return raw(s >= P ? s - P : s);
+    }
+    friend ModP operator-(ModP a, ModP b) {
+        return raw(a.v >= b.v ? a.v - b.v : a.v + P - b.v);
+    }
+    friend ModP operator*(ModP a, ModP b) {
+        return raw(reduce((std::uint64_t)a.v * b.v));
+    }
+
+    ModP pow(std::uint64_t e) const {
+        ModP r(1), b = *this;
+        for (; e; e >>= 1, b = b * b) {
+            if (e & 1) r = r * b;
+        }
+        return r;
+    }
+    // Fermat: a^(P-2) = a^-1
+    ModP inverse() const { return pow(P - 2); }
+
+private:
+    static ModP raw(std::uint32_t x) {
+        ModP m;
+        m.v = x;
+        return m;
+    }
+
+    // -P^-1 mod 2^32 by Newton's iteration (each step doubles the correct bits)
+    static constexpr std::uint32_t neg_inv() {
+        std::uint32_t x = P;
+        for (int i = 0; i < 4; ++i) x *= 2 - P * x;
+        return 0u - x;
+    }
+    static constexpr std::uint32_t NEG_INV = neg_inv();
+    static constexpr std::uint64_t R2 = ((std::uint64_t(1) << 32) % P) * ((std::uint64_t(1) << 32) % P) % P;
+
+    // t * 2^-32 mod P, for t < P * 2^32
+    static std::uint32_t reduce(std::uint64_t t) {
+        std::uint32_t m = (std::uint32_t)t * NEG_INV;
+        std::uint32_t u = (std::uint32_t)((t + (std::uint64_t)m * P) >> 32);
+        return u >= P ? u - P : u;
+    }
+};
+
+// Plan for one prime and one power-of-two size, like FftPlan: roots and the
+// bit-reversal permutation are built once, forward()/inverse() only permute
+// and run the butterflies. inverse() includes the 1/N scaling.
+template <std::uint32_t P>
+class NttPlan {
+public:
+    typedef ModP<P> value_type;
+
+    explicit NttPlan(std::size_t N, int threads = 1)
+        : N_(N), threads_(threads < 1 ? 1 : threads), rev_(make_bitrev(N)), tw_(N / 2 + 1), itw_(N / 2 + 1) {
+        if (N == 0 || (N & (N - 1)) != 0) throw std::invalid_argument("NttPlan: N must be a power of two");
+        if ((P - 1) % N != 0) throw std::invalid_argument("NttPlan: N does not divide P - 1");
+        value_type w = value_type(NTT_ROOT).pow((P - 1) / N), iw = w.inverse();
+        tw_[0] = itw_[0] = value_type(1);
+        for (std::size_t k = 1; k < tw_.size(); ++k) {
+            tw_[k] = tw_[k - 1] * w;
+            itw_[k] = itw_[k - 1] * iw;
+        }
+        n_inv_ = value_type((std::uint64_t)N).inverse();
+    }
+
+    std::size_t size() const { return N_; }
+
+    void forward(value_type* a) const { transform(a, tw_.data()); }
+
+    void inverse(value_type* a) const {
+        transform(a, itw_.data());
+        for (std::size_t i = 0; i < N_; ++i) a[i] = a[i] * n_inv_;
+    }
+
+private:
+    void transform(value_type* a, const value_type* tw) const {
+        for (std::size_t i = 0; i < N_; ++i) {
+            if (i < rev_[i]) std::swap(a[i], a[rev_[i]]);
+        }
+        // Same threshold as FftPlan: below it a parallel region costs more than it saves
+        butterfly_stages(a, N_, tw, N_ >= 4096 ? threads_ : 1);
+    }
+
+    std::size_t N_;
+    int threads_;
+    std::vector<std::size_t> rev_;
+    std::vector<value_type> tw_, itw_;
+    value_type n_inv_;
+};
+
+// Cyclic-free (linear) convolution of a and b mod P, with a and b already reduced
+template <std::uint32_t P>
+inline std::vector<std::uint32_t> ntt_convolve_mod(const std::vector<std::uint32_t>& a,
+                                                   const std::vector<std::uint32_t>& b, int threads = 1) {
+    if (a.empty() || b.empty()) return std::vector<std::uint32_t>();
+    std::size_t n = a.size() + b.size() - 1, N = 1;
+    while (N < n) N <<= 1;
+    if (N > NTT_MAX_SIZE) throw std::invalid_argument("ntt_convolve_mod: result longer than NTT_MAX_SIZE");
+    NttPlan<P> plan(N, threads);
+    std::vector<ModP<P> > fa(N), fb(N);
+    for (std::size_t i = 0; i < a.size(); ++i) fa[i] = ModP<P>(a[i]);
+    for (std::size_t i = 0; i < b.size(); ++i) fb[i] = ModP<P>(b[i]);
+    plan.forward(fa.data());
+    plan.forward(fb.data());
+    for (std::size_t i = 0; i < N; ++i) fa[i] = fa[i] * fb[i];
+    plan.inverse(fa.data());
+    std::vector<std::uint32_t> c(n);
+    for (std::size_t i = 0; i < n; ++i) c[i] = fa[i].value();
+    return c;
+}
+
+// a mod P for signed a
+template <std::uint32_t P>
+inline std::vector<std::uint32_t> reduce_mod(const std::vector<long long>& a) {
+    std::vector<std::uint32_t> r(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        long long m = a[i] % (long long)P;
+        r[i] = (std::uint32_t)(m < 0 ? m + P : m);
+    }
+    return r;
+}
+
+// Exact linear convolution (polynomial product) of integer sequences.
+// Each coefficient is bounded by min(|a|,|b|) * max|a| * max|b|; one, two or
+// three primes are used so that their product exceeds twice that bound, and
+// Garner's method recovers the signed value. Results must fit in long long.
+inline std::vector<long long> ntt_convolve(const std::vector<long long>& a, const std::vector<long long>& b,
+                                           int threads = 1) {
+    if (a.empty() || b.empty()) return std::vector<long long>();
+    unsigned long long ma = 0, mb = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) ma = std::max(ma, (unsigned long long)(a[i] < 0 ? -a[i] : a[i]));
+    for (std::size_t i = 0; i < b.size(); ++i) mb = std::max(mb, (unsigned long long)(b[i] < 0 ? -b[i] : b[i]));
+    // 2 * bound, in long double to survive overflow
+    long double bound = 2.0L * std::min(a.size(), b.size()) * (long double)ma * (long double)mb;
+    if (bound >= 9.2233720368547758e18L) throw std::invalid_argument("ntt_convolve: result may not fit in long long");
+
+    const unsigned long long p1 = NTT_P1, p2 = NTT_P2, p3 = NTT_P3;
+    std::size_t n = a.size() + b.size() - 1;
+    std::vector<long long> c(n);
+
+    std::vector<std::uint32_t> r1 = ntt_convolve_mod<NTT_P1>(reduce_mod<NTT_P1>(a), reduce_mod<NTT_P1>(b), threads);
+    if (bound < (long double)p1) {
+        for (std::size_t i = 0; i < n; ++i) c[i] = r1[i] > p1 / 2 ? (long long)r1[i] - (long long)p1 : r1[i];
+        return c;
+    }
+    std::vector<std::uint32_t> r2 = ntt_convolve_mod<NTT_P2>(reduce_mod<NTT_P2>(a), reduce_mod<NTT_P2>(b), threads);
+    const unsigned long long p1_inv_p2 = ModP<NTT_P2>(p1).inverse().value();
+    if (bound < (long double)p1 * p2) {
+        unsigned long long m = p1 * p2;
+        for (std::size_t i = 0; i < n; ++i) {
+            // x = r1 + p1 * t, t = (r2 - r1) / p1 mod p2
+            unsigned long long t = (r2[i] + p2 - r1[i] % p2) % p2 * p1_inv_p2 % p2;
+            unsigned long long x = r1[i] + p1 * t;
+            c[i] = x > m / 2 ? (long long)(x - m) : (long long)x;
+        }
+        return c;
+    }
+    std::vector<std::uint32_t> r3 = ntt_convolve_mod<NTT_P3>(reduce_mod<NTT_P3>(a), reduce_mod<NTT_P3>(b), threads);
+    const unsigned long long p1_inv_p3 = ModP<NTT_P3>(p1).inverse().value();
+    const unsigned long long p2_inv_p3 = ModP<NTT_P3>(p2).inverse().value();
+    // M = p1*p2*p3 > 2^64, so x = r1 + p1*t2 + p1*p2*t3 is formed mod 2^64.
+    // With |result| < 2^63, far below M/2, the result is negative exactly
+    // when the top digit t3 is above p3/2, and then it is x - M.
+    const unsigned long long m = p1 * p2 * p3;   // mod 2^64
+    for (std::size_t i = 0; i < n; ++i) {
+        unsigned long long t2 = (r2[i] + p2 - r1[i] % p2) % p2 * p1_inv_p2 % p2;
+        // t3 = ((r3 - r1) / p1 - t2) / p2 mod p3
+        unsigned long long u = (r3[i] + p3 - r1[i] % p3) % p3 * p1_inv_p3 % p3;
+        unsigned long long t3 = (u + p3 - t2 % p3) % p3 * p2_inv_p3 % p3;
+        unsigned long long x = r1[i] + p1 * t2 + p1 * p2 * t3;
+        if (t3 > p3 / 2) x -= m;
+        c[i] = (long long)x;
+    }
+    return c;
+}
+
+// Big-integer product. Numbers are little-endian vectors of 32-bit limbs;
+// each limb is split into two 16-bit digits so the digit convolution stays
+// below 2^63 for any size the NTT supports, then carries are propagated.
+inline std::vector<std::uint32_t> bigint_multiply(const std::vector<std::uint32_t>& a,
+                                                  const std::vector<std::uint32_t>& b, int threads = 1) {
+    if (a.empty() || b.empty()) return std::vector<std::uint32_t>();
+    std::vector<long long> da(2 * a.size()), db(2 * b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) { da[2 * i] = a[i] & 0xffff; da[2 * i + 1] = a[i] >> 16; }
+    for (std::size_t i = 0; i < b.size(); ++i) { db[2 * i] = b[i] & 0xffff; db[2 * i + 1] = b[i] >> 16; }
+    std::vector<long long> c = ntt_convolve(da, db, threads);
+
+    std::vector<std::uint32_t> out(a.size() + b.size(), 0);
+    unsigned long long carry = 0;
+    for (std::size_t i = 0; i < 2 * out.size(); ++i) {
+        carry += i < c.size() ? (unsigned long long)c[i] : 0;
+        std::uint32_t digit = (std::uint32_t)(carry & 0xffff);
+        carry >>= 16;
+        if (i % 2 == 0) out[i / 2] = digit;
+        else out[i / 2] |= digit << 16;
+    }
+    return out;
+}
+
+#endif
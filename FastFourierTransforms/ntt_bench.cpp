@@ -0,0 +1,148 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <random>
+#include "ntt.h"
+
+using namespace std;
+
+// Big-integer multiplication: schoolbook O(n^2), Karatsuba O(n^1.58) and the
+// NTT O(n log n), on random numbers of n 32-bit limbs. Every product is
+// checked against the schoolbook result (Karatsuba only, above SCHOOL_MAX).
+// Usage: ./ntt_bench [-t threads] [limbs ...]   (default: 16 .. 2^20)
+
+typedef vector<uint32_t> BigInt;
+
+const size_t SCHOOL_MAX = 1 << 14;   // schoolbook gets too slow beyond this
+const size_t KARATSUBA_MAX = 1 << 18;
+const size_t KARATSUBA_LEAF = 32;    // schoolbook below this many digits
+
+BigInt schoolbook(const BigInt& a, const BigInt& b) {
+    BigInt r(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            uint64_t t = (uint64_t)a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        r[i + b.size()] = (uint32_t)carry;
+    }
+    return r;
+}
+
+// Karatsuba on polynomials of 16-bit digits with int64 coefficients (carries
+// deferred to the end), so the middle term needs no signed big-integer
+// subtraction: r = a*b for n-digit a, b; r has 2n-1 coefficients
+void karatsuba(const int64_t* a, const int64_t* b, size_t n, int64_t* r) {
+    if (n <= KARATSUBA_LEAF) {
+        fill(r, r + 2 * n - 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) r[i + j] += a[i] * b[j];
+        }
+        return;
+    }
+    size_t lo = n / 2, hi = n - lo;
+    // a = a0 + x^lo a1; (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 is the middle term
+    vector<int64_t> sa(hi), sb(hi), z0(2 * lo - 1), z1(2 * hi - 1), z2(2 * hi - 1);
+    for (size_t i = 0; i < hi; ++i) {
+        sa[i] = a[lo + i] + (i < lo ? a[i] : 0);
+        sb[i] = b[lo + i] + (i < lo ? b[i] : 0);
+    }
+    karatsuba(a, b, lo, z0.data());
+    karatsuba(a + lo, b + lo, hi, z2.data());
+    karatsuba(sa.data(), sb.data(), hi, z1.data());
+    for (size_t i = 0; i < z0.size(); ++i) z1[i] -= z0[i];
+    for (size_t i = 0; i < z2.size(); ++i) z1[i] -= z2[i];
+
+    fill(r, r + 2 * n - 1, 0);
+    for (size_t i = 0; i < z0.size(); ++i) r[i] += z0[i];
+    for (size_t i = 0; i < z1.size(); ++i) r[lo + i] += z1[i];
+    for (size_t i = 0; i < z2.size(); ++i) r[2 * lo + i] += z2[i];
+}
+
+// Equal-length operands only, as in the benchmark
+BigInt karatsuba_multiply(const BigInt& a, const BigInt& b) {
+    size_t n = 2 * a.size();
+    vector<int64_t> da(n), db(n), c(2 * n - 1);
+    for (size_t i = 0; i < a.size(); ++i) {
+        da[2 * i] = a[i] & 0xffff; da[2 * i + 1] = a[i] >> 16;
+        db[2 * i] = b[i] & 0xffff; db[2 * i + 1] = b[i] >> 16;
+    }
+    karatsuba(da.data(), db.data(), n, c.data());
+    BigInt out(a.size() + b.size(), 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < 2 * out.size(); ++i) {
+        carry += i < c.size() ? (uint64_t)c[i] : 0;
+        uint32_t digit = (uint32_t)(carry & 0xffff);
+        carry >>= 16;
+        if (i % 2 == 0) out[i / 2] = digit;
+        else out[i / 2] |= digit << 16;
+    }
+    return out;
+}
+
+// Seconds per call, repeating until at least 0.2 s has elapsed
+template <typename F>
+double time_it(F f) {
+    int reps = 0;
+    double seconds = 0;
+    auto start = chrono::steady_clock::now();
+    while (seconds < 0.2) {
+        f();
+        ++reps;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    return seconds / reps;
+}
+
+int main(int argc, char** argv) {
+    int threads = 1;
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else sizes.push_back(atol(argv[i]));
+    }
+    if (sizes.empty()) {
+        for (size_t n = 16; n <= (1 << 20); n *= 4) sizes.push_back(n);
+    }
+
+    mt19937 rng(12345);
+    cout << setw(9) << "limbs" << setw(16) << "schoolbook (ms)" << setw(16) << "Karatsuba (ms)"
+         << setw(12) << "NTT (ms)" << setw(10) << "check" << endl;
+    for (size_t n : sizes) {
+        BigInt a(n), b(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = rng();
+            b[i] = rng();
+        }
+        BigInt p_ntt = bigint_multiply(a, b, threads), p_ref;
+        double t_school = -1, t_kara = -1;
+        if (n <= SCHOOL_MAX) {
+            p_ref = schoolbook(a, b);
+            t_school = time_it([&] { schoolbook(a, b); });
+        }
+        if (n <= KARATSUBA_MAX) {
+            BigInt p_kara = karatsuba_multiply(a, b);
+            if (p_ref.empty()) p_ref = p_kara;
+            else if (p_kara != p_ref) cout << "Karatsuba mismatch at " << n << " limbs" << endl;
+            t_kara = time_it([&] { karatsuba_multiply(a, b); });
+        }
+        double t_ntt = time_it([&] { bigint_multiply(a, b, threads); });
+
+        cout << setw(9) << n;
+        if (t_school >= 0) cout << setw(16) << t_school * 1e3;
+        else cout << setw(16) << "-";
+        if (t_kara >= 0) cout << setw(16) << t_kara * 1e3;
+        else cout << setw(16) << "-";
+        cout << setw(12) << t_ntt * 1e3 << setw(10)
+             << (p_ref.empty() ? "n/a" : p_ntt == p_ref ? "ok" : "WRONG") << endl;
+    }
+
+    return 0;
+}
@@ -2,45 +2,90 @@
 #include <complex>
 #include <vector>
 #include <cmath>
+#include <cstdlib>
+#include <string>
 #include <omp.h>
+#include "fft.h"
+#include "fft_io.h"
 
 using namespace std;
 
-typedef complex<double> Complex;
-const double PI = acos(-1);
+// Sub-transforms smaller than this run serially inside one task; spawning
+// tasks for them costs more than the work they contain
+const size_t TASK_CUTOFF = 1 << 12;
 
-// Recursive Cooley–Tukey FFT with OpenMP
-void fft(vector<Complex>& a) {
-    int N = a.size();
-    if (N <= 1) return;
+// At and above this size the stage-parallel iterative plan is used instead
+// of tasks: every stage splits N/2 butterflies evenly over all threads
+const size_t STAGE_PARALLEL_MIN = 1 << 18;
 
-    // Divide: even and odd
-    vector<Complex> even(N/2), odd(N/2);
-    for (int i = 0; 2*i < N; ++i) {
-        even[i] = a[2*i];
-        odd[i] = a[2*i + 1];
-    }
+enum OmpFftMode { MODE_TASKS, MODE_STAGES };
 
-    // Conquer: parallel recursive calls
-    #pragma omp parallel sections
-    {
-        #pragma omp section
-        { fft(even); }
+// Task mode: recursive Cooley–Tukey with one omp task per half and a
+// taskloop per combine step, down to TASK_CUTOFF points; below it each task
+// runs the serial iterative leaf (see fft_recursive() in fft.h).
+// Stage mode: the iterative radix-2 plan splitting every stage over threads.
+FftPlan make_omp_plan(size_t N, int threads, OmpFftMode mode) {
+    FftVariant variant = mode == MODE_TASKS ? FftVariant(FFT_RECURSIVE, 2, TASK_CUTOFF) : FftVariant(FFT_RADIX2);
+    return FftPlan(N, FFT_FORWARD, threads, variant);
+}
 
-        #pragma omp section
-        { fft(odd); }
-    }
+OmpFftMode default_mode(size_t N) {
+    return N >= STAGE_PARALLEL_MIN ? MODE_STAGES : MODE_TASKS;
+}
+
+double time_fft(const FftPlan& plan, const vector<Complex>& x, vector<Complex>& X, int reps) {
+    plan.execute(x.data(), X.data());   // warm-up
+    double start = omp_get_wtime();
+    for (int r = 0; r < reps; ++r) plan.execute(x.data(), X.data());
+    return (omp_get_wtime() - start) / reps;
+}
 
-    // Combine
-    #pragma omp parallel for
-    for (int k = 0; k < N/2; ++k) {
-        Complex t = polar(1.0, -2 * PI * k / N) * odd[k];
-        a[k] = even[k] + t;
-        a[k + N/2] = even[k] - t;
+// Command-line mode: FFT of a signal file (see fft_io.h) into another.
+// ./omp_Cooley_Tukey [-t threads] [-p float|double|long] [-l interleaved|split] [-i] input|synth:N output
+int run_tool(int argc, char** argv) {
+    int threads = omp_get_max_threads();
+    uint32_t precision = sizeof(double);
+    SignalLayout layout = SIGNAL_INTERLEAVED;
+    FftDirection dir = FFT_FORWARD;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc) precision = parse_precision(argv[++i]);
+        else if (arg == "-l" && i + 1 < argc) layout = parse_layout(argv[++i]);
+        else if (arg == "-i") dir = FFT_BACKWARD;
+        else paths.push_back(arg);
+    }
+    if (paths.size() != 2) {
+        cerr << "Usage: " << argv[0] << " [-t threads] [-p float|double|long] [-l interleaved|split] [-i]"
+             << " input|synth:N output" << endl;
+        return 1;
     }
+
+    double seconds;
+    if (precision == sizeof(float)) seconds = fft_file<float>(paths[0], paths[1], layout, dir, threads);
+    else if (precision == sizeof(double)) seconds = fft_file<double>(paths[0], paths[1], layout, dir, threads);
+    else seconds = fft_file<long double>(paths[0], paths[1], layout, dir, threads);
+
+    size_t N = MappedSignal::open(paths[1]).size();
+    cout << "N = " << N << " (" << real_bytes_name(precision) << ", " << threads << " threads) -> " << paths[1] << endl;
+    cout << "FFT time: " << seconds << " s, " << 5.0 * N * log2((double)N) / seconds * 1e-9 << " GFLOP/s" << endl;
+    return 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Only numbers: the scaling run below; anything else: a file to transform
+    bool tool = false;
+    for (int i = 1; i < argc; ++i) tool = tool || string(argv[i]).find_first_not_of("0123456789") != string::npos;
+    if (tool) {
+        try {
+            return run_tool(argc, argv);
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
     int N = 8;
     vector<Complex> x(N);
 
@@ -52,10 +97,38 @@ int main() {
     cout << "Input:\n";
     for (auto val : x) cout << val << endl;
 
-    fft(x);
+    // Setup once, reuse for every frame of this length
+    FftPlan plan = make_omp_plan(N, omp_get_max_threads(), default_mode(N));
+    vector<Complex> X(N);
+    plan.execute(x.data(), X.data());
 
     cout << "\nFFT Output:\n";
-    for (auto val : x) cout << val << endl;
+    for (auto val : X) cout << val << endl;
+
+    // Strong scaling from 1 thread to all cores: ./omp_Cooley_Tukey [log2 N] [reps]
+    int log2N = argc > 1 ? atoi(argv[1]) : 20;
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    size_t big_N = size_t(1) << log2N;
+    vector<Complex> big_x(big_N), big_X(big_N);
+    for (size_t i = 0; i < big_N; ++i) {
+        big_x[i] = sin(2 * PI * i / big_N) + 0.5 * cos(2 * PI * 17 * i / big_N);
+    }
+
+    FftPlan serial_plan = make_omp_plan(big_N, 1, MODE_STAGES);
+    double t_serial = time_fft(serial_plan, big_x, big_X, reps);
+    vector<Complex> reference = big_X;
+
+    cout << "\nScaling for N = 2^" << log2N << " (serial iterative: " << t_serial << " s)\n";
+    cout << "threads\ttasks (s)\tspeedup\tstages (s)\tspeedup\tmax error\n";
+    for (int threads = 1; threads <= omp_get_num_procs(); ++threads) {
+        double t_tasks = time_fft(make_omp_plan(big_N, threads, MODE_TASKS), big_x, big_X, reps);
+        double err = 0;
+        for (size_t i = 0; i < big_N; ++i) err = max(err, abs(big_X[i] - reference[i]));
+        double t_stages = time_fft(make_omp_plan(big_N, threads, MODE_STAGES), big_x, big_X, reps);
+        for (size_t i = 0; i < big_N; ++i) err = max(err, abs(big_X[i] - reference[i]));
+        cout << threads << "\t" << t_tasks << "\t" << t_serial / t_tasks << "x\t"
+             << t_stages << "\t" << t_serial / t_stages << "x\t" << err << endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "fft_ooc.h"
+#include "fft_io.h"
+
+using namespace std;
+
+// Out-of-core FFT of a signal file (fft_io.h) of interleaved complex doubles.
+// Usage: ./ooc_fft [-m budget_MB] [-t threads] [-i] [-T tmp_file] input output
+//   input "synth:N" writes a test signal of N samples to output.in first;
+//   -i computes the inverse (unnormalized) transform.
+// For N <= 2^22 the result is checked against the in-memory FftPlan.
+int main(int argc, char** argv) {
+    size_t budget_mb = 256;
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    FftDirection dir = FFT_FORWARD;
+    string tmp;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-m" && i + 1 < argc) budget_mb = atol(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "-T" && i + 1 < argc) tmp = argv[++i];
+        else if (arg == "-i") dir = FFT_BACKWARD;
+        else paths.push_back(arg);
+    }
+    if (paths.size() != 2) {
+        cerr << "Usage: " << argv[0] << " [-m budget_MB] [-t threads] [-i] [-T tmp_file] input|synth:N output" << endl;
+        return 1;
+    }
+    string input = paths[0], output = paths[1];
+
+    size_t N;
+    try {
+        if (input.compare(0, 6, "synth:") == 0) {
+            N = atol(input.c_str() + 6);
+            input = output + ".in";
+            // Filled through the mapping in 1 MB pieces, so the generator needs no memory either
+            MappedSignal f = MappedSignal::create(input, N, sizeof(double));
+            vector<Complex> piece(1 << 16);
+            for (size_t n0 = 0; n0 < N; n0 += piece.size()) {
+                size_t count = min(piece.size(), N - n0);
+                for (size_t i = 0; i < count; ++i) piece[i] = synth_sample(n0 + i, N);
+                f.store(piece.data(), n0, count);
+            }
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    try {
+        size_t in_offset;
+        {
+            MappedSignal in = MappedSignal::open(input);
+            if (!in.is_native<double>()) throw invalid_argument(input + ": needs interleaved double samples");
+            N = in.size();
+            in_offset = in.data_offset();
+        }
+        OocFftPlan plan(N, budget_mb << 20, dir, threads);
+        cout << "N = " << N << " = " << plan.n1() << " x " << plan.n2() << ", " << threads << " thread(s), "
+             << (plan.buffer_bytes() >> 20) << " MB of slabs (" << plan.slab_width(1) << " / "
+             << plan.slab_width(2) << " columns per slab)" << endl;
+
+        // The input is read before the transform, since output may be the same file
+        bool check = N <= (1 << 22);
+        vector<Complex> x(check ? N : 0);
+        if (check) MappedSignal::open(input).load(x.data());
+
+        auto start = chrono::steady_clock::now();
+        plan.execute(input, output, tmp, in_offset, SIGNAL_HEADER_SIZE);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        // The header goes in last, without truncating: in place, the input
+        // header and samples must survive until pass 1 has read them
+        MappedSignal::create(output, N, sizeof(double), SIGNAL_INTERLEAVED, true);
+        // Each pass reads and writes the whole signal once
+        double gb = 4.0 * N * sizeof(Complex) / 1e9;
+        cout << "Time: " << seconds << " s (" << gb / seconds << " GB/s of I/O, "
+             << 5.0 * N * log2((double)N) / seconds * 1e-9 << " GFLOP/s)" << endl;
+
+        if (check) {
+            vector<Complex> X(N), ref;
+            MappedSignal::open(output).load(X.data());
+            FftPlan(N, dir).execute(x, ref);
+            double err = 0, norm = 0;
+            for (size_t k = 0; k < N; ++k) {
+                err = max(err, abs(X[k] - ref[k]));
+                norm = max(norm, abs(ref[k]));
+            }
+            cout << "Max relative error vs in-memory FFT: " << err / norm << endl;
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <iomanip>
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include "fft.h"
+#include "dft.h"
+
+using namespace std;
+
+// Throughput and accuracy of the same FFT source built for float, double and
+// long double. Error is the max |X - X_dft| / max |X_dft| against the
+// double-precision direct dft() oracle.
+// Usage: ./precision_bench [N ...]   (default: 256 1000 1009 1536 4096)
+
+template <typename Real>
+void bench(size_t N, const vector<Complex>& x, const vector<Complex>& oracle, const char* name) {
+    typedef complex<Real> C;
+    FftPlanT<Real> plan(N);
+    vector<C> in(N), out(N);
+    for (size_t i = 0; i < N; ++i) in[i] = C(Real(x[i].real()), Real(x[i].imag()));
+
+    plan.execute(in.data(), out.data());
+    double err = 0, norm = 0;
+    for (size_t k = 0; k < N; ++k) {
+        Complex v(double(out[k].real()), double(out[k].imag()));
+        err = max(err, abs(v - oracle[k]));
+        norm = max(norm, abs(oracle[k]));
+    }
+
+    // Repeat until at least 0.2 s has elapsed
+    int reps = 0;
+    double seconds = 0;
+    auto start = chrono::steady_clock::now();
+    while (seconds < 0.2) {
+        plan.execute(in.data(), out.data());
+        ++reps;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    double per_fft = seconds / reps;
+    double gflops = 5.0 * N * log2((double)N) / per_fft * 1e-9;
+
+    cout << setw(8) << N << setw(13) << name << setw(14) << per_fft * 1e6
+         << setw(12) << gflops << setw(16) << err / norm << endl;
+}
+
+int main(int argc, char** argv) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(atol(argv[i]));
+    if (sizes.empty()) sizes = {256, 1000, 1009, 1536, 4096};
+
+    cout << setw(8) << "N" << setw(13) << "precision" << setw(14) << "time (us)"
+         << setw(12) << "GFLOP/s" << setw(16) << "rel. error" << endl;
+    for (size_t N : sizes) {
+        vector<Complex> x(N);
+        for (size_t i = 0; i < N; ++i) {
+            x[i] = Complex(sin(2 * PI * 3 * i / N) + 0.3 * cos(2 * PI * 0.37 * i), 0.1 * sin(0.5 * i));
+        }
+        vector<Complex> oracle = dft(x);
+
+        bench<float>(N, x, oracle, "float");
+        bench<double>(N, x, oracle, "double");
+        bench<long double>(N, x, oracle, "long double");
+    }
+
+    return 0;
+}
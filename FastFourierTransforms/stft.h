@@ -0,0 +1,129 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include <chrono>
+#include <string>
+#include "fft_real.h"
+
+enum WindowType { WINDOW_RECT, WINDOW_HANN, WINDOW_HAMMING, WINDOW_BLACKMAN };
+
+inline WindowType parse_window(const std::string& name) {
+    if (name == "rect") return WINDOW_RECT;
+    if (name == "hann") return WINDOW_HANN;
+    if (name == "hamming") return WINDOW_HAMMING;
+    if (name == "blackman") return WINDOW_BLACKMAN;
+    throw std::invalid_argument("unknown window: " + name);
+}
+
+// Periodic window of length N (the form that sums to a constant under overlap-add)
+inline std::vector<double> make_window(WindowType type, std::size_t N) {
+    std::vector<double> w(N, 1.0);
+    for (std::size_t n = 0; n < N; ++n) {
+        double x = 2 * PI * n / N;
+        switch (type) {
+        case WINDOW_RECT: break;
+        case WINDOW_HANN: w[n] = 0.5 - 0.5 * std::cos(x); break;
+        case WINDOW_HAMMING: w[n] = 0.54 - 0.46 * std::cos(x); break;
+        case WINDOW_BLACKMAN: w[n] = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x); break;
+        }
+    }
+    return w;
+}
+
+// Streaming short-time Fourier transform with weighted overlap-add resynthesis.
+// Samples are pushed in chunks of any size. Every `hop` samples the last
+// `frame` samples (held in a ring buffer) are windowed and transformed with
+// a real FFT; the N/2+1 bins are handed to a callback, which may modify them;
+// the frame is inverse transformed, windowed again and overlap-added. Output
+// is the (processed) input delayed by frame - hop samples, emitted hop
+// samples at a time, so memory stays at a few frames however long the stream.
+// Output is normalized by sum_k w^2(j + k*hop), which gives exact
+// reconstruction for any window/hop pair where that sum is nonzero.
+class StftProcessor {
+public:
+    StftProcessor(std::size_t frame, std::size_t hop, WindowType window = WINDOW_HANN)
+        : frame_(frame), hop_(hop), plan_(frame), window_(make_window(window, frame)),
+          ring_(frame, 0.0), ola_(frame, 0.0), norm_(hop, 0.0),
+          time_(frame), bins_(frame / 2 + 1) {
+        if (hop == 0 || hop > frame) throw std::invalid_argument("StftProcessor: hop must be in [1, frame]");
+        for (std::size_t j = 0; j < hop; ++j) {
+            for (std::size_t n = j; n < frame; n += hop) norm_[j] += window_[n] * window_[n];
+            if (norm_[j] == 0) throw std::invalid_argument("StftProcessor: window/hop pair cannot be inverted");
+        }
+    }
+
+    std::size_t frame_size() const { return frame_; }
+    std::size_t hop_size() const { return hop_; }
+    std::size_t delay() const { return frame_ - hop_; }
+    std::size_t frames() const { return frames_; }
+    double mean_frame_seconds() const { return frames_ ? frame_seconds_ / frames_ : 0; }
+    double max_frame_seconds() const { return max_frame_seconds_; }
+
+    // Push n samples; writes completed output samples to out (room for n + hop
+    // needed) and returns how many. on_frame(Complex* bins, size_t nbins) is
+    // called once per frame.
+    template <typename F>
+    std::size_t process(const double* in, std::size_t n, double* out, F on_frame) {
+        std::size_t written = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            ring_[head_] = in[i];
+            head_ = (head_ + 1) % frame_;
+            if (++pending_ == hop_) {
+                pending_ = 0;
+                run_frame(on_frame);
+                written += emit(out + written);
+            }
+        }
+        return written;
+    }
+
+    std::size_t process(const double* in, std::size_t n, double* out) {
+        return process(in, n, out, [](Complex*, std::size_t) {});
+    }
+
+private:
+    template <typename F>
+    void run_frame(F& on_frame) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // Oldest sample sits at head_
+        for (std::size_t i = 0; i < frame_; ++i) {
+            time_[i] = ring_[(head_ + i) % frame_] * window_[i];
+        }
+        plan_.r2c(time_.data(), bins_.data());
+        on_frame(bins_.data(), bins_.size());
+        plan_.c2r(bins_.data(), time_.data());
+
+        double scale = 1.0 / frame_;
+        for (std::size_t i = 0; i < frame_; ++i) {
+            ola_[(ola_head_ + i) % frame_] += time_[i] * scale * window_[i];
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++frames_;
+        frame_seconds_ += elapsed;
+        max_frame_seconds_ = std::max(max_frame_seconds_, elapsed);
+    }
+
+    // The first hop samples of the accumulator receive no more frames
+    std::size_t emit(double* out) {
+        for (std::size_t j = 0; j < hop_; ++j) {
+            double& v = ola_[(ola_head_ + j) % frame_];
+            out[j] = v / norm_[j];
+            v = 0;
+        }
+        ola_head_ = (ola_head_ + hop_) % frame_;
+        return hop_;
+    }
+
+    std::size_t frame_, hop_;
+    RealFftPlan plan_;
+    std::vector<double> window_, ring_, ola_, norm_;
+    std::vector<double> time_;
+    std::vector<Complex> bins_;
+    std::size_t head_ = 0, pending_ = 0, ola_head_ = 0;
+    std::size_t frames_ = 0;
+    double frame_seconds_ = 0, max_frame_seconds_ = 0;
+};
+
+#endif
@@ -0,0 +1,649 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+// Cache-blocked GEMM, C = alpha * A * B + beta * C, in the GotoBLAS / BLIS
+// structure:
+//
+//   for ic in steps of mc:                 A panel mc x kc, packed once -> L3
+//     for pc in steps of kc:
+//       for jc in steps of nc (threads):   B block kc x nc, packed per thread -> L2
+//         for ir in steps of mr:           A sliver mr x kc -> L1
+//           for jr in steps of nr:         micro-kernel: mr x nr tile of C in registers
+//
+// Packing copies each A block into row slivers (mr values per k) and each B
+// panel into column slivers (nr values per k), zero-padded to whole tiles,
+// so the micro-kernel streams both operands with unit stride from aligned
+// memory whatever the layout and leading dimensions of A and B. The
+// micro-kernel keeps the mr x nr tile in vector registers; per k it loads a
+// row of the B sliver as nr/W vectors and multiply-adds it into each tile row
+// with that row's A element broadcast. The loop order is GotoBLAS's for C^T =
+// B^T A^T: the broadcast operand (the A sliver) stays in L1 and the
+// vector-loaded one (the B block) streams from L2.
+//
+// Element types: gemm<T, In> multiplies A and B of type In and accumulates in
+// T, the type of C (In defaults to T). Every combination runs on the portable
+// kernel; these have their own x86 kernels:
+//   double, float     AVX-512 (8 x 24 / 8 x 48) and AVX2+FMA (6 x 8 / 6 x 16)
+//   int32 -> int32    AVX-512 (8 x 48) and AVX2 (6 x 16); wraps on overflow
+//   int8  -> int32    AVX-512 VNNI (8 x 48, vpdpbusd) and AVX2 (6 x 8, vpmaddwd)
+// The int8 kernels consume k four at a time (kr = 4): a packed sliver holds
+// groups of four consecutive k values per row (column), so one 32-bit lane
+// carries a 4-element dot product. int8 products are exact in int32 for k up
+// to 131072.
+//
+// The kernels for a type are all compiled into the same binary and the
+// fastest one the CPU supports is chosen at run time. Other architectures
+// (e.g. Apple M1) use the portable kernel, which the compiler vectorizes for
+// the native ISA. Set GEMM_KERNEL=portable|avx2|avx512|avx512vnni to force a
+// kernel.
+
+// Packs rows i0 .. i0+rows of A (or columns j0 .. j0+cols of B), k range p0 .. p0+kc,
+// into one sliver of width w (mr or nr) in groups of kr: dst[p*w + i*kr + p%kr]
+template <typename In>
+struct GemmPack {
+    typedef void (*Function)(const MatrixView<const In>& M, std::size_t first, std::size_t count, std::size_t p0,
+                             std::size_t kc, std::size_t w, std::size_t kr, In* dst);
+};
+
+// Micro-kernel: c[i*ldc + j] = alpha * sum_p A(i, p) B(p, j) + beta * c[i*ldc + j] for
+// the whole mr x nr tile from packed slivers a and b (kc a multiple of kr).
+// beta == 0 overwrites C without reading it.
+template <typename T, typename In = T>
+struct GemmKernel {
+    typedef void (*MicroKernel)(std::size_t kc, const In* a, const In* b, T* c, std::size_t ldc, T alpha, T beta);
+    const char* name;
+    MicroKernel kernel;
+    typename GemmPack<In>::Function pack_a, pack_b;
+    std::size_t mr, nr;       // register tile
+    std::size_t kr;           // k values per packed group
+    std::size_t mc, kc, nc;   // cache blocks
+    std::size_t b_extra;      // In elements after each packed B sliver, for the kernel's own use
+};
+
+// A(i0 .. i0+rows, p0 .. p0+kc) -> a row sliver of mr; rows past `rows` and k past kc zero
+template <typename In>
+inline void gemm_pack_a(const MatrixView<const In>& A, std::size_t i0, std::size_t rows, std::size_t p0,
+                        std::size_t kc, std::size_t mr, std::size_t kr, In* dst) {
+    std::size_t rs = A.row_stride(), cs = A.col_stride();
+    std::size_t kp = (kc + kr - 1) / kr * kr;
+    for (std::size_t i = 0; i < mr; ++i) {
+        const In* src = i < rows ? A.data() + (i0 + i) * rs + p0 * cs : nullptr;
+        for (std::size_t p = 0; p < kp; p += kr) {
+            for (std::size_t r = 0; r < kr; ++r) {
+                dst[p * mr + i * kr + r] = src && p + r < kc ? src[(p + r) * cs] : In(0);
+            }
+        }
+    }
+}
+
+// B(p0 .. p0+kc, j0 .. j0+cols) -> a column sliver of nr; columns past `cols` and k past kc zero
+template <typename In>
+inline void gemm_pack_b(const MatrixView<const In>& B, std::size_t j0, std::size_t cols, std::size_t p0,
+                        std::size_t kc, std::size_t nr, std::size_t kr, In* dst) {
+    std::size_t rs = B.row_stride(), cs = B.col_stride();
+    std::size_t kp = (kc + kr - 1) / kr * kr;
+    for (std::size_t p = 0; p < kp; p += kr, dst += nr * kr) {
+        for (std::size_t r = 0; r < kr; ++r) {
+            if (p + r >= kc) {
+                for (std::size_t j = 0; j < nr; ++j) dst[j * kr + r] = In(0);
+                continue;
+            }
+            const In* src = B.data() + (p0 + p + r) * rs + j0 * cs;
+            for (std::size_t j = 0; j < cols; ++j) dst[j * kr + r] = src[j * cs];
+            for (std::size_t j = cols; j < nr; ++j) dst[j * kr + r] = In(0);
+        }
+    }
+}
+
+// Portable kernel on 16-byte vectors of T (GCC / Clang vector extensions: SSE2
+// on x86, NEON on ARM); kr = 1 and NR a multiple of 16 / sizeof(T)
+template <typename T, typename In, int MR, int NR>
+inline void gemm_micro_portable(std::size_t kc, const In* a, const In* b, T* c, std::size_t ldc, T alpha, T beta) {
+    typedef T Vec __attribute__((vector_size(16)));
+    const int W = 16 / sizeof(T), NV = NR / W;
+    Vec acc[MR][NV];
+#pragma GCC unroll 16
+    for (int i = 0; i < MR; ++i) {
+#pragma GCC unroll 16
+        for (int v = 0; v < NV; ++v) acc[i][v] = Vec{};
+    }
+    for (std::size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+        T wide[NR];
+        for (int j = 0; j < NR; ++j) wide[j] = T(b[j]);
+        Vec bv[NV];
+        std::memcpy(bv, wide, sizeof(bv));
+#pragma GCC unroll 16
+        for (int i = 0; i < MR; ++i) {
+#pragma GCC unroll 16
+            for (int v = 0; v < NV; ++v) acc[i][v] += T(a[i]) * bv[v];
+        }
+    }
+    for (int i = 0; i < MR; ++i, c += ldc) {
+        T row[NR];
+        std::memcpy(row, acc[i], sizeof(row));
+        for (int j = 0; j < NR; ++j) c[j] = beta == T(0) ? alpha * row[j] : alpha * row[j] + beta * c[j];
+    }
+}
+
+#ifdef GEMM_X86
+// double 6 x 8: twelve ymm accumulators, two loads of B and six broadcasts of A per k
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_avx2_f64(std::size_t kc, const double* a, const double* b, double* c, std::size_t ldc,
+                                double alpha, double beta) {
+    __m256d acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+#pragma GCC unroll 4
+    for (std::size_t p = 0; p < kc; ++p, a += 6, b += 8) {
+        __m256d b0 = _mm256_load_pd(b), b1 = _mm256_load_pd(b + 4);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            __m256d ai = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+    }
+    __m256d va = _mm256_set1_pd(alpha), vb = _mm256_set1_pd(beta);
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i, c += ldc) {
+        __m256d r0 = _mm256_mul_pd(va, acc[i][0]), r1 = _mm256_mul_pd(va, acc[i][1]);
+        if (beta != 0) {
+            r0 = _mm256_fmadd_pd(vb, _mm256_loadu_pd(c), r0);
+            r1 = _mm256_fmadd_pd(vb, _mm256_loadu_pd(c + 4), r1);
+        }
+        _mm256_storeu_pd(c, r0);
+        _mm256_storeu_pd(c + 4, r1);
+    }
+}
+
+// double 8 x 24: 24 zmm accumulators, three loads of B and eight broadcasts of A per k
+__attribute__((target("avx512f")))
+inline void gemm_micro_avx512_f64(std::size_t kc, const double* a, const double* b, double* c, std::size_t ldc,
+                                  double alpha, double beta) {
+    __m512d acc[8][3];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) acc[i][0] = acc[i][1] = acc[i][2] = _mm512_setzero_pd();
+#pragma GCC unroll 4
+    for (std::size_t p = 0; p < kc; ++p, a += 8, b += 24) {
+        __m512d b0 = _mm512_load_pd(b), b1 = _mm512_load_pd(b + 8), b2 = _mm512_load_pd(b + 16);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            __m512d ai = _mm512_set1_pd(a[i]);
+            acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+            acc[i][2] = _mm512_fmadd_pd(ai, b2, acc[i][2]);
+        }
+    }
+    __m512d va = _mm512_set1_pd(alpha), vb = _mm512_set1_pd(beta);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i, c += ldc) {
+#pragma GCC unroll 3
+        for (int v = 0; v < 3; ++v) {
+            __m512d r = _mm512_mul_pd(va, acc[i][v]);
+            if (beta != 0) r = _mm512_fmadd_pd(vb, _mm512_loadu_pd(c + 8 * v), r);
+            _mm512_storeu_pd(c + 8 * v, r);
+        }
+    }
+}
+
+// float 6 x 16: the double kernel's shape with eight floats per ymm
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_avx2_f32(std::size_t kc, const float* a, const float* b, float* c, std::size_t ldc,
+                                float alpha, float beta) {
+    __m256 acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+#pragma GCC unroll 4
+    for (std::size_t p = 0; p < kc; ++p, a += 6, b += 16) {
+        __m256 b0 = _mm256_load_ps(b), b1 = _mm256_load_ps(b + 8);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+    __m256 va = _mm256_set1_ps(alpha), vb = _mm256_set1_ps(beta);
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i, c += ldc) {
+        __m256 r0 = _mm256_mul_ps(va, acc[i][0]), r1 = _mm256_mul_ps(va, acc[i][1]);
+        if (beta != 0) {
+            r0 = _mm256_fmadd_ps(vb, _mm256_loadu_ps(c), r0);
+            r1 = _mm256_fmadd_ps(vb, _mm256_loadu_ps(c + 8), r1);
+        }
+        _mm256_storeu_ps(c, r0);
+        _mm256_storeu_ps(c + 8, r1);
+    }
+}
+
+// float 8 x 48: the double kernel's shape with sixteen floats per zmm
+__attribute__((target("avx512f")))
+inline void gemm_micro_avx512_f32(std::size_t kc, const float* a, const float* b, float* c, std::size_t ldc,
+                                  float alpha, float beta) {
+    __m512 acc[8][3];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) acc[i][0] = acc[i][1] = acc[i][2] = _mm512_setzero_ps();
+#pragma GCC unroll 4
+    for (std::size_t p = 0; p < kc; ++p, a += 8, b += 48) {
+        __m512 b0 = _mm512_load_ps(b), b1 = _mm512_load_ps(b + 16), b2 = _mm512_load_ps(b + 32);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            __m512 ai = _mm512_set1_ps(a[i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+            acc[i][2] = _mm512_fmadd_ps(ai, b2, acc[i][2]);
+        }
+    }
+    __m512 va = _mm512_set1_ps(alpha), vb = _mm512_set1_ps(beta);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i, c += ldc) {
+#pragma GCC unroll 3
+        for (int v = 0; v < 3; ++v) {
+            __m512 r = _mm512_mul_ps(va, acc[i][v]);
+            if (beta != 0) r = _mm512_fmadd_ps(vb, _mm512_loadu_ps(c + 16 * v), r);
+            _mm512_storeu_ps(c + 16 * v, r);
+        }
+    }
+}
+
+// int32 6 x 16: vpmulld + vpaddd in place of the FMA
+__attribute__((target("avx2")))
+inline void gemm_micro_avx2_i32(std::size_t kc, const std::int32_t* a, const std::int32_t* b, std::int32_t* c,
+                                std::size_t ldc, std::int32_t alpha, std::int32_t beta) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+#pragma GCC unroll 2
+    for (std::size_t p = 0; p < kc; ++p, a += 6, b += 16) {
+        __m256i b0 = _mm256_load_si256((const __m256i*)b), b1 = _mm256_load_si256((const __m256i*)(b + 8));
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            __m256i ai = _mm256_set1_epi32(a[i]);
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_mullo_epi32(ai, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_mullo_epi32(ai, b1));
+        }
+    }
+    __m256i va = _mm256_set1_epi32(alpha), vb = _mm256_set1_epi32(beta);
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i, c += ldc) {
+#pragma GCC unroll 2
+        for (int v = 0; v < 2; ++v) {
+            __m256i r = _mm256_mullo_epi32(va, acc[i][v]);
+            __m256i* cv = (__m256i*)(c + 8 * v);
+            if (beta != 0) r = _mm256_add_epi32(r, _mm256_mullo_epi32(vb, _mm256_loadu_si256(cv)));
+            _mm256_storeu_si256(cv, r);
+        }
+    }
+}
+
+// int32 8 x 48
+__attribute__((target("avx512f")))
+inline void gemm_micro_avx512_i32(std::size_t kc, const std::int32_t* a, const std::int32_t* b, std::int32_t* c,
+                                  std::size_t ldc, std::int32_t alpha, std::int32_t beta) {
+    __m512i acc[8][3];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) acc[i][0] = acc[i][1] = acc[i][2] = _mm512_setzero_si512();
+#pragma GCC unroll 2
+    for (std::size_t p = 0; p < kc; ++p, a += 8, b += 48) {
+        __m512i b0 = _mm512_load_si512(b), b1 = _mm512_load_si512(b + 16), b2 = _mm512_load_si512(b + 32);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            __m512i ai = _mm512_set1_epi32(a[i]);
+            acc[i][0] = _mm512_add_epi32(acc[i][0], _mm512_mullo_epi32(ai, b0));
+            acc[i][1] = _mm512_add_epi32(acc[i][1], _mm512_mullo_epi32(ai, b1));
+            acc[i][2] = _mm512_add_epi32(acc[i][2], _mm512_mullo_epi32(ai, b2));
+        }
+    }
+    __m512i va = _mm512_set1_epi32(alpha), vb = _mm512_set1_epi32(beta);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i, c += ldc) {
+#pragma GCC unroll 3
+        for (int v = 0; v < 3; ++v) {
+            __m512i r = _mm512_mullo_epi32(va, acc[i][v]);
+            if (beta != 0) r = _mm512_add_epi32(r, _mm512_mullo_epi32(vb, _mm512_loadu_si512(c + 16 * v)));
+            _mm512_storeu_si512(c + 16 * v, r);
+        }
+    }
+}
+
+// int8 -> int32 6 x 8, kr = 4. Each group of four k is sign-extended to int16
+// and vpmaddwd adds products in pairs, so a column's two int32 lanes hold
+// partial sums that are folded together at the end. Exact: no int16 saturation.
+__attribute__((target("avx2")))
+inline void gemm_micro_avx2_i8(std::size_t kc, const std::int8_t* a, const std::int8_t* b, std::int32_t* c,
+                               std::size_t ldc, std::int32_t alpha, std::int32_t beta) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+    for (std::size_t p = 0; p < kc; p += 4, a += 24, b += 32) {
+        // Columns 0-3 and 4-7, four k each
+        __m256i b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)b));
+        __m256i b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + 16)));
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            std::int32_t quad;
+            std::memcpy(&quad, a + 4 * i, 4);
+            __m256i ai = _mm256_broadcastq_epi64(_mm_cvtepi8_epi16(_mm_cvtsi32_si128(quad)));
+            acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_madd_epi16(ai, b0));
+            acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_madd_epi16(ai, b1));
+        }
+    }
+    __m256i va = _mm256_set1_epi32(alpha), vb = _mm256_set1_epi32(beta);
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i, c += ldc) {
+        // Pairwise sums come out as columns 0 1 4 5 2 3 6 7
+        __m256i r = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc[i][0], acc[i][1]), 0xD8);
+        r = _mm256_mullo_epi32(va, r);
+        if (beta != 0) r = _mm256_add_epi32(r, _mm256_mullo_epi32(vb, _mm256_loadu_si256((const __m256i*)c)));
+        _mm256_storeu_si256((__m256i*)c, r);
+    }
+}
+
+// vpdpbusd multiplies unsigned by signed bytes, so the VNNI kernel's A sliver
+// is stored offset by 128 (a + 128 as uint8, an xor of the sign bit) ...
+inline void gemm_pack_a_vnni(const MatrixView<const std::int8_t>& A, std::size_t i0, std::size_t rows,
+                             std::size_t p0, std::size_t kc, std::size_t mr, std::size_t kr, std::int8_t* dst) {
+    gemm_pack_a(A, i0, rows, p0, kc, mr, kr, dst);
+    std::size_t kp = (kc + kr - 1) / kr * kr;
+    for (std::size_t e = 0; e < mr * kp; ++e) dst[e] = (std::int8_t)(dst[e] ^ 0x80);
+}
+
+// ... and each B sliver is followed by the nr int32 corrections 128 * sum_p B(p, j)
+inline void gemm_pack_b_vnni(const MatrixView<const std::int8_t>& B, std::size_t j0, std::size_t cols,
+                             std::size_t p0, std::size_t kc, std::size_t nr, std::size_t kr, std::int8_t* dst) {
+    gemm_pack_b(B, j0, cols, p0, kc, nr, kr, dst);
+    std::size_t kp = (kc + kr - 1) / kr * kr;
+    for (std::size_t j = 0; j < nr; ++j) {
+        std::uint32_t sum = 0;
+        for (std::size_t p = 0; p < kp; p += kr) {
+            for (std::size_t r = 0; r < kr; ++r) sum += (std::uint32_t)(std::int32_t)dst[p * nr + j * kr + r];
+        }
+        std::int32_t correction = (std::int32_t)(sum << 7);
+        std::memcpy(dst + kp * nr + 4 * j, &correction, 4);
+    }
+}
+
+// int8 -> int32 8 x 48, kr = 4: one vpdpbusd per 16 columns x 4 k. Padded
+// rows of A read 128 instead of 0, but only feed tile rows that are dropped.
+__attribute__((target("avx512f,avx512vnni")))
+inline void gemm_micro_avx512vnni_i8(std::size_t kc, const std::int8_t* a, const std::int8_t* b, std::int32_t* c,
+                                     std::size_t ldc, std::int32_t alpha, std::int32_t beta) {
+    __m512i acc[8][3];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) acc[i][0] = acc[i][1] = acc[i][2] = _mm512_setzero_si512();
+#pragma GCC unroll 2
+    for (std::size_t p = 0; p < kc; p += 4, a += 32, b += 192) {
+        __m512i b0 = _mm512_load_si512(b), b1 = _mm512_load_si512(b + 64), b2 = _mm512_load_si512(b + 128);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            std::int32_t quad;
+            std::memcpy(&quad, a + 4 * i, 4);
+            __m512i ai = _mm512_set1_epi32(quad);
+            acc[i][0] = _mm512_dpbusd_epi32(acc[i][0], ai, b0);
+            acc[i][1] = _mm512_dpbusd_epi32(acc[i][1], ai, b1);
+            acc[i][2] = _mm512_dpbusd_epi32(acc[i][2], ai, b2);
+        }
+    }
+    // b now points at the column corrections
+    __m512i fix[3] = { _mm512_loadu_si512(b), _mm512_loadu_si512(b + 64), _mm512_loadu_si512(b + 128) };
+    __m512i va = _mm512_set1_epi32(alpha), vb = _mm512_set1_epi32(beta);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i, c += ldc) {
+#pragma GCC unroll 3
+        for (int v = 0; v < 3; ++v) {
+            __m512i r = _mm512_mullo_epi32(va, _mm512_sub_epi32(acc[i][v], fix[v]));
+            if (beta != 0) r = _mm512_add_epi32(r, _mm512_mullo_epi32(vb, _mm512_loadu_si512(c + 16 * v)));
+            _mm512_storeu_si512(c + 16 * v, r);
+        }
+    }
+}
+#endif
+
+// First usable kernel in kernels[0 .. count), best first and portable last, or
+// the one named by GEMM_KERNEL if it is usable
+template <typename T, typename In>
+inline GemmKernel<T, In> choose_gemm_kernel(const GemmKernel<T, In>* kernels, const bool* usable, int count) {
+    const char* force = std::getenv("GEMM_KERNEL");
+    for (int i = 0; force && i < count; ++i) {
+        if (usable[i] && !std::strcmp(force, kernels[i].name)) return kernels[i];
+    }
+    for (int i = 0; i < count; ++i) {
+        if (usable[i]) return kernels[i];
+    }
+    return kernels[count - 1];
+}
+
+// Kernel and blocking for C of type T and A, B of type In, chosen once per process.
+// Blocks: A sliver mr x kc in a third of L1, B block kc x nc in about half of L2.
+template <typename T, typename In>
+inline GemmKernel<T, In> select_gemm_kernel() {
+    GemmKernel<T, In> portable = { "portable", gemm_micro_portable<T, In, 6, 8>, gemm_pack_a<In>, gemm_pack_b<In>,
+                                   6, 8, 1, 4032, 256, 256, 0 };
+    return portable;
+}
+
+template <>
+inline GemmKernel<double, double> select_gemm_kernel<double, double>() {
+    typedef GemmKernel<double, double> K;
+    K portable = { "portable", gemm_micro_portable<double, double, 6, 8>, gemm_pack_a<double>, gemm_pack_b<double>,
+                   6, 8, 1, 4032, 256, 256, 0 };
+#ifdef GEMM_X86
+    K kernels[] = { { "avx512", gemm_micro_avx512_f64, gemm_pack_a<double>, gemm_pack_b<double>, 8, 24, 1, 4032, 256, 480, 0 },
+                    { "avx2", gemm_micro_avx2_f64, gemm_pack_a<double>, gemm_pack_b<double>, 6, 8, 1, 4032, 256, 96, 0 },
+                    portable };
+    __builtin_cpu_init();
+    bool usable[] = { __builtin_cpu_supports("avx512f") != 0,
+                      __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0, true };
+    return choose_gemm_kernel(kernels, usable, 3);
+#endif
+    return portable;
+}
+
+template <>
+inline GemmKernel<float, float> select_gemm_kernel<float, float>() {
+    typedef GemmKernel<float, float> K;
+    K portable = { "portable", gemm_micro_portable<float, float, 6, 16>, gemm_pack_a<float>, gemm_pack_b<float>,
+                   6, 16, 1, 4032, 512, 192, 0 };
+#ifdef GEMM_X86
+    K kernels[] = { { "avx512", gemm_micro_avx512_f32, gemm_pack_a<float>, gemm_pack_b<float>, 8, 48, 1, 4032, 512, 480, 0 },
+                    { "avx2", gemm_micro_avx2_f32, gemm_pack_a<float>, gemm_pack_b<float>, 6, 16, 1, 4032, 512, 96, 0 },
+                    portable };
+    __builtin_cpu_init();
+    bool usable[] = { __builtin_cpu_supports("avx512f") != 0,
+                      __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0, true };
+    return choose_gemm_kernel(kernels, usable, 3);
+#endif
+    return portable;
+}
+
+template <>
+inline GemmKernel<std::int32_t, std::int32_t> select_gemm_kernel<std::int32_t, std::int32_t>() {
+    typedef std::int32_t I;
+    typedef GemmKernel<I, I> K;
+    K portable = { "portable", gemm_micro_portable<I, I, 6, 8>, gemm_pack_a<I>, gemm_pack_b<I>, 6, 8, 1, 4032, 512, 192, 0 };
+#ifdef GEMM_X86
+    K kernels[] = { { "avx512", gemm_micro_avx512_i32, gemm_pack_a<I>, gemm_pack_b<I>, 8, 48, 1, 4032, 512, 480, 0 },
+                    { "avx2", gemm_micro_avx2_i32, gemm_pack_a<I>, gemm_pack_b<I>, 6, 16, 1, 4032, 512, 96, 0 },
+                    portable };
+    __builtin_cpu_init();
+    bool usable[] = { __builtin_cpu_supports("avx512f") != 0, __builtin_cpu_supports("avx2") != 0, true };
+    return choose_gemm_kernel(kernels, usable, 3);
+#endif
+    return portable;
+}
+
+template <>
+inline GemmKernel<std::int32_t, std::int8_t> select_gemm_kernel<std::int32_t, std::int8_t>() {
+    typedef std::int8_t I8;
+    typedef GemmKernel<std::int32_t, I8> K;
+    K portable = { "portable", gemm_micro_portable<std::int32_t, I8, 6, 8>, gemm_pack_a<I8>, gemm_pack_b<I8>,
+                   6, 8, 1, 4032, 1024, 192, 0 };
+#ifdef GEMM_X86
+    K kernels[] = { { "avx512vnni", gemm_micro_avx512vnni_i8, gemm_pack_a_vnni, gemm_pack_b_vnni, 8, 48, 4, 4032, 1024, 960, 192 },
+                    { "avx2", gemm_micro_avx2_i8, gemm_pack_a<I8>, gemm_pack_b<I8>, 6, 8, 4, 4032, 1024, 192, 0 },
+                    portable };
+    __builtin_cpu_init();
+    bool usable[] = { __builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512vnni") != 0,
+                      __builtin_cpu_supports("avx2") != 0, true };
+    return choose_gemm_kernel(kernels, usable, 3);
+#endif
+    return portable;
+}
+
+template <typename T, typename In = T>
+inline const GemmKernel<T, In>& gemm_kernel() {
+    static const GemmKernel<T, In> k = select_gemm_kernel<T, In>();
+    return k;
+}
+
+// Uninitialized 64-byte aligned scratch for the packed panels
+template <typename T>
+class GemmBuffer {
+public:
+    explicit GemmBuffer(std::size_t n) {
+        void* p = nullptr;
+        if (n && posix_memalign(&p, MATRIX_ALIGNMENT, n * sizeof(T)) != 0) throw std::bad_alloc();
+        data_.reset(static_cast<T*>(p));
+    }
+    T* data() const { return data_.get(); }
+
+private:
+    struct Free {
+        void operator()(T* p) const { std::free(p); }
+    };
+    std::unique_ptr<T[], Free> data_;
+};
+
+// C = beta * C
+template <typename T>
+inline void gemm_scale(T beta, const MatrixView<T>& C) {
+    for (std::size_t i = 0; i < C.rows(); ++i) {
+        for (std::size_t j = 0; j < C.cols(); ++j) C(i, j) = beta == T(0) ? T(0) : beta * C(i, j);
+    }
+}
+
+// Keeps a parameter out of template argument deduction, so a Matrix<T> or a
+// MatrixView<T> converts implicitly to the MatrixView<const T> argument
+template <typename T>
+struct GemmArg {
+    typedef T type;
+};
+
+// C = alpha * A * B + beta * C for any layouts; A is m x k, B is k x n, C is m x n.
+// A and B hold In, C and the accumulation T: gemm<std::int32_t, std::int8_t>(...)
+// for quantized int8. beta == 0 overwrites C (which may then hold garbage). All
+// threads share each packed A panel and split the columns of C in B blocks of up to nc.
+template <typename T, typename In = T>
+void gemm(T alpha, typename GemmArg<MatrixView<const In> >::type A, typename GemmArg<MatrixView<const In> >::type B,
+          T beta, typename GemmArg<MatrixView<T> >::type C, int threads = 1) {
+    std::size_t m = C.rows(), n = C.cols(), k = A.cols();
+    if (A.rows() != m || B.rows() != k || B.cols() != n) throw std::invalid_argument("gemm: shapes do not match");
+    // The micro-kernel writes rows of C: compute a column-major C as C^T = B^T A^T
+    if (C.layout() == COL_MAJOR) {
+        gemm<T, In>(alpha, B.transposed(), A.transposed(), beta, C.transposed(), threads);
+        return;
+    }
+    if (m == 0 || n == 0) return;
+    if (k == 0 || alpha == T(0)) {
+        gemm_scale(beta, C);
+        return;
+    }
+    if (threads < 1) threads = 1;
+
+    const GemmKernel<T, In>& K = gemm_kernel<T, In>();
+    std::size_t mr = K.mr, nr = K.nr, kr = K.kr;
+    std::size_t kc_max = std::min(K.kc, k);
+    std::size_t kp_max = (kc_max + kr - 1) / kr * kr;
+    std::size_t mc_max = std::min(K.mc, (m + mr - 1) / mr * mr);
+    // Narrower B blocks when there are not enough of them to go round the threads
+    std::size_t nc = std::min(K.nc, ((n + threads - 1) / threads + nr - 1) / nr * nr);
+    long n_blocks = (long)((n + nc - 1) / nc);
+    std::size_t ldc = C.ld();
+    GemmBuffer<In> a_pack(mc_max * kp_max);
+
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    {
+        // Per thread: the packed B block and one edge tile
+        GemmBuffer<In> b_pack(nc / nr * (nr * kp_max + K.b_extra));
+        GemmBuffer<T> edge(mr * nr);
+
+        for (std::size_t ic = 0; ic < m; ic += mc_max) {
+            std::size_t mc = std::min(mc_max, m - ic);
+            long slivers = (long)((mc + mr - 1) / mr);
+            for (std::size_t pc = 0; pc < k; pc += kc_max) {
+                std::size_t kc = std::min(kc_max, k - pc);
+                std::size_t kp = (kc + kr - 1) / kr * kr;
+                std::size_t a_step = mr * kp, b_step = nr * kp + K.b_extra;
+                T beta_pc = pc == 0 ? beta : T(1);
+
+                #pragma omp for schedule(static)
+                for (long s = 0; s < slivers; ++s) {
+                    std::size_t i = s * mr;
+                    K.pack_a(A, ic + i, std::min(mr, mc - i), pc, kc, mr, kr, a_pack.data() + s * a_step);
+                }
+
+                #pragma omp for schedule(static)
+                for (long jb = 0; jb < n_blocks; ++jb) {
+                    std::size_t jc = jb * nc, ncb = std::min(nc, n - jc);
+                    for (std::size_t j = 0; j < ncb; j += nr) {
+                        K.pack_b(B, jc + j, std::min(nr, ncb - j), pc, kc, nr, kr, b_pack.data() + j / nr * b_step);
+                    }
+                    for (std::size_t ir = 0; ir < mc; ir += mr) {
+                        std::size_t rows = std::min(mr, mc - ir);
+                        const In* ap = a_pack.data() + ir / mr * a_step;
+                        for (std::size_t jr = 0; jr < ncb; jr += nr) {
+                            std::size_t cols = std::min(nr, ncb - jr);
+                            const In* bp = b_pack.data() + jr / nr * b_step;
+                            T* c = C.data() + (ic + ir) * ldc + jc + jr;
+                            if (rows == mr && cols == nr) {
+                                K.kernel(kp, ap, bp, c, ldc, alpha, beta_pc);
+                                continue;
+                            }
+                            // Partial tile: full tile into the scratch, then the valid part into C
+                            T* e = edge.data();
+                            K.kernel(kp, ap, bp, e, nr, alpha, T(0));
+                            for (std::size_t i = 0; i < rows; ++i) {
+                                for (std::size_t j = 0; j < cols; ++j) {
+                                    T& cij = c[i * ldc + j];
+                                    cij = beta_pc == T(0) ? e[i * nr + j] : e[i * nr + j] + beta_pc * cij;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// C = A * B
+template <typename T, typename In = T>
+inline void gemm(typename GemmArg<MatrixView<const In> >::type A, typename GemmArg<MatrixView<const In> >::type B,
+                 MatrixView<T> C, int threads = 1) {
+    gemm<T, In>(T(1), A, B, T(0), C, threads);
+}
+
+template <typename T, typename In>
+inline void gemm(const Matrix<In>& A, const Matrix<In>& B, Matrix<T>& C, int threads = 1) {
+    gemm<T, In>(T(1), A.view(), B.view(), T(0), C.view(), threads);
+}
+
+#endif
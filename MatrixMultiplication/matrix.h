@@ -0,0 +1,190 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+// Dense matrices in one contiguous, 64-byte aligned buffer.
+//
+// Element (i, j) lives at data[i*ld + j] (row-major) or data[i + j*ld]
+// (column-major), where the leading dimension ld >= cols (resp. rows) is the
+// distance between the starts of consecutive rows (columns). By default ld
+// is padded so every row (column) starts on a 64-byte boundary: a whole
+// cache line and one AVX-512 register.
+//
+// Matrix<T> owns its buffer. MatrixView<T> is a non-owning (pointer, rows,
+// cols, ld, layout) window: the whole matrix, a block of it, its transpose
+// (the same memory read with the other layout), or memory owned by someone
+// else (a std::vector, a Metal buffer, an mmap). Kernels take views, so
+// every caller shares them without copying.
+
+enum MatrixLayout { ROW_MAJOR, COL_MAJOR };
+
+// Buffers start on, and default leading dimensions round up to, this many bytes
+const std::size_t MATRIX_ALIGNMENT = 64;
+
+template <typename T>
+class MatrixView {
+public:
+    typedef T value_type;
+
+    MatrixView() : data_(nullptr), rows_(0), cols_(0), ld_(0), layout_(ROW_MAJOR) {}
+
+    // ld = 0: tightly packed (cols for row-major, rows for column-major)
+    MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t ld = 0, MatrixLayout layout = ROW_MAJOR)
+        : data_(data), rows_(rows), cols_(cols), ld_(ld ? ld : (layout == ROW_MAJOR ? cols : rows)), layout_(layout) {
+        if (ld_ < (layout == ROW_MAJOR ? cols : rows)) throw std::invalid_argument("MatrixView: leading dimension too small");
+    }
+
+    // MatrixView<T> -> MatrixView<const T>
+    template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    MatrixView(const MatrixView<U>& v)
+        : data_(v.data()), rows_(v.rows()), cols_(v.cols()), ld_(v.ld()), layout_(v.layout()) {}
+
+    T* data() const { return data_; }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t ld() const { return ld_; }
+    MatrixLayout layout() const { return layout_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+
+    // Distance in elements between (i, j) and (i+1, j), and between (i, j) and (i, j+1)
+    std::size_t row_stride() const { return layout_ == ROW_MAJOR ? ld_ : 1; }
+    std::size_t col_stride() const { return layout_ == ROW_MAJOR ? 1 : ld_; }
+
+    T& operator()(std::size_t i, std::size_t j) const { return data_[i * row_stride() + j * col_stride()]; }
+
+    // rows x cols window starting at (i0, j0)
+    MatrixView block(std::size_t i0, std::size_t j0, std::size_t rows, std::size_t cols) const {
+        if (i0 + rows > rows_ || j0 + cols > cols_) throw std::out_of_range("MatrixView::block: outside the matrix");
+        return MatrixView(data_ + i0 * row_stride() + j0 * col_stride(), rows, cols, ld_, layout_, NoCheck());
+    }
+
+    // The transpose, without moving any data
+    MatrixView transposed() const {
+        return MatrixView(data_, cols_, rows_, ld_, layout_ == ROW_MAJOR ? COL_MAJOR : ROW_MAJOR, NoCheck());
+    }
+
+private:
+    struct NoCheck {};
+    MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t ld, MatrixLayout layout, NoCheck)
+        : data_(data), rows_(rows), cols_(cols), ld_(ld), layout_(layout) {}
+
+    T* data_;
+    std::size_t rows_, cols_, ld_;
+    MatrixLayout layout_;
+};
+
+// Smallest leading dimension >= n whose rows start on MATRIX_ALIGNMENT bytes
+template <typename T>
+inline std::size_t aligned_ld(std::size_t n) {
+    std::size_t per_line = MATRIX_ALIGNMENT % sizeof(T) == 0 ? MATRIX_ALIGNMENT / sizeof(T) : 1;
+    return (n + per_line - 1) / per_line * per_line;
+}
+
+template <typename T>
+class Matrix {
+public:
+    typedef T value_type;
+
+    Matrix() : rows_(0), cols_(0), ld_(0), layout_(ROW_MAJOR) {}
+
+    // Zero-initialized; ld = 0 picks aligned_ld<T>() of the row (column) length
+    Matrix(std::size_t rows, std::size_t cols, MatrixLayout layout = ROW_MAJOR, std::size_t ld = 0)
+        : rows_(rows), cols_(cols), layout_(layout) {
+        std::size_t inner = layout == ROW_MAJOR ? cols : rows;
+        std::size_t outer = layout == ROW_MAJOR ? rows : cols;
+        ld_ = ld ? ld : aligned_ld<T>(inner);
+        if (ld_ < inner) throw std::invalid_argument("Matrix: leading dimension too small");
+        allocate(outer * ld_);
+    }
+
+    Matrix(const Matrix& o) : rows_(o.rows_), cols_(o.cols_), ld_(o.ld_), layout_(o.layout_) {
+        allocate(o.elements());
+        if (elements()) std::memcpy(data_.get(), o.data_.get(), elements() * sizeof(T));
+    }
+    Matrix(Matrix&& o) noexcept : Matrix() { swap(o); }
+    Matrix& operator=(Matrix o) {
+        swap(o);
+        return *this;
+    }
+
+    void swap(Matrix& o) {
+        std::swap(data_, o.data_);
+        std::swap(rows_, o.rows_);
+        std::swap(cols_, o.cols_);
+        std::swap(ld_, o.ld_);
+        std::swap(layout_, o.layout_);
+    }
+
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t ld() const { return ld_; }
+    MatrixLayout layout() const { return layout_; }
+
+    T& operator()(std::size_t i, std::size_t j) { return layout_ == ROW_MAJOR ? data_[i * ld_ + j] : data_[i + j * ld_]; }
+    const T& operator()(std::size_t i, std::size_t j) const {
+        return layout_ == ROW_MAJOR ? data_[i * ld_ + j] : data_[i + j * ld_];
+    }
+
+    MatrixView<T> view() { return MatrixView<T>(data_.get(), rows_, cols_, ld_, layout_); }
+    MatrixView<const T> view() const { return MatrixView<const T>(data_.get(), rows_, cols_, ld_, layout_); }
+    operator MatrixView<T>() { return view(); }
+    operator MatrixView<const T>() const { return view(); }
+
+    MatrixView<T> block(std::size_t i0, std::size_t j0, std::size_t rows, std::size_t cols) {
+        return view().block(i0, j0, rows, cols);
+    }
+    MatrixView<const T> block(std::size_t i0, std::size_t j0, std::size_t rows, std::size_t cols) const {
+        return view().block(i0, j0, rows, cols);
+    }
+
+    void fill(const T& value) {
+        MatrixView<T> v = view();
+        for (std::size_t i = 0; i < rows_; ++i) {
+            for (std::size_t j = 0; j < cols_; ++j) v(i, j) = value;
+        }
+    }
+
+private:
+    struct Free {
+        void operator()(T* p) const { std::free(p); }
+    };
+
+    std::size_t elements() const { return (layout_ == ROW_MAJOR ? rows_ : cols_) * ld_; }
+
+    void allocate(std::size_t n) {
+        void* p = nullptr;
+        if (n && posix_memalign(&p, MATRIX_ALIGNMENT, n * sizeof(T)) != 0) throw std::bad_alloc();
+        if (p) std::memset(p, 0, n * sizeof(T));
+        data_.reset(static_cast<T*>(p));
+    }
+
+    std::unique_ptr<T[], Free> data_;
+    std::size_t rows_, cols_, ld_;
+    MatrixLayout layout_;
+};
+
+// dst = src element by element; any layouts and leading dimensions
+template <typename T, typename U>
+inline void copy_matrix(const MatrixView<T>& src, const MatrixView<U>& dst) {
+    if (src.rows() != dst.rows() || src.cols() != dst.cols()) throw std::invalid_argument("copy_matrix: shapes differ");
+    if (dst.layout() == ROW_MAJOR) {
+        for (std::size_t i = 0; i < dst.rows(); ++i) {
+            for (std::size_t j = 0; j < dst.cols(); ++j) dst(i, j) = src(i, j);
+        }
+    } else {
+        for (std::size_t j = 0; j < dst.cols(); ++j) {
+            for (std::size_t i = 0; i < dst.rows(); ++i) dst(i, j) = src(i, j);
+        }
+    }
+}
+
+#endif
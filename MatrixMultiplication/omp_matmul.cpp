@@ -1,145 +1,263 @@
 #include <iostream> // For input/output operations (e.g., std::cout)
-#include <vector>   // For using std::vector to represent matrices
+#include <iomanip>  // For the report table
+#include <fstream>  // For the CSV report
+#include <sstream>  // For parsing shape and list arguments
+#include <string>
+#include <vector>   // For the lists of shapes, types and thread counts
+#include <random>   // For the test matrices
 #include <chrono>   // For measuring execution time
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
 #include <omp.h>    // For OpenMP directives and functions
+#include "matrix.h" // Matrix<T>: one contiguous, 64-byte aligned buffer per matrix
+#include "gemm.h"   // Cache-blocked, packed GEMM
+#include "roofline.h" // Measured peak multiply-add rate and STREAM bandwidth
 
-// Define matrix dimensions as constants for easy modification
-// For demonstration, keep these relatively small. For larger matrices,
-// you'll see more significant performance differences.
-const int ROWS_A = 500;    // Number of rows in matrix A
-const int COLS_A_ROWS_B = 500; // Number of columns in matrix A, and rows in matrix B
-const int COLS_B = 500;    // Number of columns in matrix B
-
-// Function to print a small portion of a matrix for verification
-void printMatrixPartial(const std::vector<std::vector<int>>& matrix, int rows, int cols, int print_limit = 5) {
-    for (int i = 0; i < std::min(rows, print_limit); ++i) {
-        for (int j = 0; j < std::min(cols, print_limit); ++j) {
-            std::cout << matrix[i][j] << "\t";
-        }
-        if (cols > print_limit) {
-            std::cout << "...";
-        }
-        std::cout << std::endl;
-    }
-    if (rows > print_limit) {
-        std::cout << "..." << std::endl;
-    }
+// Matrix multiplication benchmark: for every shape, element type and thread
+// count on the command line, times gemm() (best of the repetitions) and reports
+//   GFLOP/s    2 m n k / time (GOP/s for the integer types)
+//   GB/s       modelled memory traffic / time, see gemm_traffic()
+//   intensity  2 m n k / modelled traffic, in operations per byte
+//   roof       min(peak, intensity * bandwidth): the roofline ceiling, from the
+//              peak multiply-add rate of the kernel's instructions and the
+//              STREAM triad bandwidth, both measured at the same thread count
+//   bound      "memory" if the bandwidth term is the lower one, else "compute"
+// Small products are also timed with the sequential triple loop, which gives
+// the speedup and checks every element; larger ones are spot-checked.
+//
+// The test matrices hold small whole numbers (-8 .. 7), so every partial sum
+// is an integer far below 2^24 and all types, float included, must agree
+// exactly with the reference.
+//
+// Usage: ./omp_matmul [-s 500] [-s MxKxN ...] [--min 256 --max 4096]
+//                     [-p double,float,int32,int8] [-t 1,4] [-r 3]
+//                     [--naive-max 512] [--csv file]
+// -s adds a shape (N is N x N x N); --min / --max add the square sizes from
+// min to max, doubling. Without either it runs 500 x 500 x 500.
+
+struct Shape {
+    std::size_t m, k, n;
+};
+
+struct Options {
+    std::vector<Shape> shapes;
+    std::vector<std::string> types;
+    std::vector<int> threads;
+    int reps;
+    std::size_t naive_max;
+    std::string csv;
+};
+
+// Bytes moved to and from memory by gemm() under the blocking of `kernel`:
+// A is packed once, B once per mc-row panel of A, and C is written by the
+// first kc slice of k and read and written by each later one. The packed
+// blocks are assumed to stay in cache; like STREAM, write-allocate reads are
+// not counted.
+template <typename T, typename In>
+double gemm_traffic(const GemmKernel<T, In>& kernel, const Shape& s) {
+    double a_passes = 1, b_passes = (double)((s.m + kernel.mc - 1) / kernel.mc);
+    double c_passes = (double)((s.k + kernel.kc - 1) / kernel.kc);
+    return sizeof(In) * (a_passes * s.m * s.k + b_passes * s.k * s.n) + sizeof(T) * (2 * c_passes - 1) * s.m * s.n;
 }
 
-int main() {
-    // 1. Matrix Initialization
-    // Create matrices A, B, and C (result matrix)
-    // Matrices are represented as vectors of vectors for simplicity.
-    // In real-world high-performance computing, 1D arrays are often preferred for better cache locality.
-    std::vector<std::vector<int>> matrixA(ROWS_A, std::vector<int>(COLS_A_ROWS_B));
-    std::vector<std::vector<int>> matrixB(COLS_A_ROWS_B, std::vector<int>(COLS_B));
-    std::vector<std::vector<int>> matrixC_sequential(ROWS_A, std::vector<int>(COLS_B, 0));
-    std::vector<std::vector<int>> matrixC_parallel(ROWS_A, std::vector<int>(COLS_B, 0));
-
-    // Populate matrixA and matrixB with some values
-    // Using simple sequential values for predictability
-    for (int i = 0; i < ROWS_A; ++i) {
-        for (int j = 0; j < COLS_A_ROWS_B; ++j) {
-            matrixA[i][j] = i + j + 1;
+// Sequential triple loop (ijk order): C[i][j] = sum(A[i][k] * B[k][j])
+template <typename T, typename In>
+void naive_matmul(const Matrix<In>& A, const Matrix<In>& B, Matrix<T>& C) {
+    for (std::size_t i = 0; i < A.rows(); ++i) {
+        for (std::size_t j = 0; j < B.cols(); ++j) {
+            T sum = 0;
+            for (std::size_t k = 0; k < A.cols(); ++k) sum += T(A(i, k)) * T(B(k, j));
+            C(i, j) = sum;
         }
     }
+}
 
-    for (int i = 0; i < COLS_A_ROWS_B; ++i) {
-        for (int j = 0; j < COLS_B; ++j) {
-            matrixB[i][j] = i * j + 2;
+// Elements of C that differ from the exact product: all of them against
+// `reference` if given, otherwise a fixed sample of 256
+template <typename T, typename In>
+std::size_t count_errors(const Matrix<In>& A, const Matrix<In>& B, const Matrix<T>& C, const Matrix<T>* reference) {
+    std::size_t errors = 0;
+    if (reference) {
+        for (std::size_t i = 0; i < C.rows(); ++i) {
+            for (std::size_t j = 0; j < C.cols(); ++j) errors += C(i, j) != (*reference)(i, j);
         }
+        return errors;
     }
+    std::mt19937 rng(5);
+    for (int s = 0; s < 256; ++s) {
+        std::size_t i = rng() % C.rows(), j = rng() % C.cols();
+        T sum = 0;
+        for (std::size_t k = 0; k < A.cols(); ++k) sum += T(A(i, k)) * T(B(k, j));
+        errors += C(i, j) != sum;
+    }
+    return errors;
+}
 
-    std::cout << "Matrices initialized. Dimensions: A(" << ROWS_A << "x" << COLS_A_ROWS_B
-              << "), B(" << COLS_A_ROWS_B << "x" << COLS_B << "), C(" << ROWS_A << "x" << COLS_B << ")" << std::endl;
+template <typename F>
+double best_time(int reps, F f) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
 
-    // --- Sequential Matrix Multiplication ---
-    std::cout << "\n--- Starting Sequential Matrix Multiplication ---" << std::endl;
-    auto start_sequential = std::chrono::high_resolution_clock::now();
+// STREAM bandwidth per thread count, measured once
+double stream_bandwidth(int threads) {
+    static std::vector<double> measured;
+    if ((int)measured.size() <= threads) measured.resize(threads + 1, 0);
+    if (measured[threads] == 0) measured[threads] = measure_stream_bandwidth(threads);
+    return measured[threads];
+}
 
-    // Standard triple-nested loop for matrix multiplication (ijk order)
-    // C[i][j] = sum(A[i][k] * B[k][j]) for k from 0 to COLS_A_ROWS_B-1
-    for (int i = 0; i < ROWS_A; ++i) {
-        for (int j = 0; j < COLS_B; ++j) {
-            for (int k = 0; k < COLS_A_ROWS_B; ++k) {
-                matrixC_sequential[i][j] += matrixA[i][k] * matrixB[k][j];
-            }
-        }
+template <typename T, typename In>
+void run(const char* type, const Options& opt, std::ostream* csv) {
+    const GemmKernel<T, In>& kernel = gemm_kernel<T, In>();
+    std::vector<double> peak(opt.threads.size());
+    for (std::size_t t = 0; t < opt.threads.size(); ++t) {
+        peak[t] = measure_peak_ops<T, In>(kernel.name, opt.threads[t]);
     }
 
-    auto end_sequential = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_sequential = end_sequential - start_sequential;
-    std::cout << "Sequential computation finished in: " << duration_sequential.count() << " seconds" << std::endl;
-
-    // --- Parallel Matrix Multiplication with OpenMP ---
-    std::cout << "\n--- Starting Parallel Matrix Multiplication with OpenMP ---" << std::endl;
-
-    // Set the number of threads (optional, OpenMP usually defaults to number of cores)
-    // omp_set_num_threads(4); // Uncomment to explicitly set thread count
-
-    auto start_parallel = std::chrono::high_resolution_clock::now();
-
-    // The `#pragma omp parallel for` directive tells OpenMP to parallelize the loop.
-    // It divides the iterations of the `i` loop among the available threads.
-    // Each thread will compute a portion of the rows of matrix C independently.
-    //
-    // Default data sharing rules:
-    // - `i` is implicitly private (loop variable).
-    // - `j` and `k` are implicitly private (loop variables within the parallel region).
-    // - `matrixA`, `matrixB`, `matrixC_parallel` are implicitly shared (accessed by all threads).
-    //   This is safe for `matrixC_parallel` because each thread writes to distinct rows,
-    //   avoiding race conditions on the output elements.
-    //
-    // Loop order (ijk) is generally cache-friendly for C++'s row-major order:
-    // - `matrixC_parallel[i][j]` accesses elements contiguously in memory for `j`.
-    // - `matrixA[i][k]` accesses elements contiguously in memory for `k`.
-    // - `matrixB[k][j]` accesses elements column-wise, which can be a cache bottleneck,
-    //   but for large matrices, the `i` loop parallelization often dominates.
-    #pragma omp parallel for
-    for (int i = 0; i < ROWS_A; ++i) {
-        for (int j = 0; j < COLS_B; ++j) {
-            for (int k = 0; k < COLS_A_ROWS_B; ++k) {
-                matrixC_parallel[i][j] += matrixA[i][k] * matrixB[k][j];
-            }
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> value(-8, 7);
+    for (const Shape& s : opt.shapes) {
+        Matrix<In> A(s.m, s.k), B(s.k, s.n);
+        Matrix<T> C(s.m, s.n);
+        for (std::size_t i = 0; i < s.m; ++i) {
+            for (std::size_t j = 0; j < s.k; ++j) A(i, j) = In(value(rng));
         }
-    }
+        for (std::size_t i = 0; i < s.k; ++i) {
+            for (std::size_t j = 0; j < s.n; ++j) B(i, j) = In(value(rng));
+        }
+
+        // The sequential baseline, for shapes small enough to run it
+        bool naive = std::max(std::max(s.m, s.k), s.n) <= opt.naive_max;
+        Matrix<T> reference(naive ? s.m : 0, naive ? s.n : 0);
+        double naive_time = naive ? best_time(1, [&] { naive_matmul(A, B, reference); }) : 0;
+
+        double ops = 2.0 * s.m * s.n * s.k, bytes = gemm_traffic(kernel, s);
+        for (std::size_t t = 0; t < opt.threads.size(); ++t) {
+            int threads = opt.threads[t];
+            double time = best_time(opt.reps, [&] { gemm(A, B, C, threads); });
+            std::size_t errors = count_errors(A, B, C, naive ? &reference : nullptr);
 
-    auto end_parallel = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_parallel = end_parallel - start_parallel;
-    std::cout << "Parallel computation finished in: " << duration_parallel.count() << " seconds" << std::endl;
-
-    // --- Verification (Optional) ---
-    // Compare a few elements of the results to ensure correctness
-    bool correct = true;
-    for (int i = 0; i < ROWS_A; ++i) {
-        for (int j = 0; j < COLS_B; ++j) {
-            if (matrixC_sequential[i][j] != matrixC_parallel[i][j]) {
-                correct = false;
-                break;
+            double bandwidth = stream_bandwidth(threads), intensity = ops / bytes;
+            double roof = std::min(peak[t], intensity * bandwidth);
+            const char* bound = intensity * bandwidth < peak[t] ? "memory" : "compute";
+            std::ostringstream shape;
+            shape << s.m << "x" << s.k << "x" << s.n;
+            std::cout << std::setprecision(4) << std::setw(7) << type << std::setw(11) << kernel.name
+                      << std::setw(17) << shape.str() << std::setw(4) << threads << std::setw(12) << time
+                      << std::setw(10) << ops / time * 1e-9 << std::setw(8) << bytes / time * 1e-9 << std::setw(8)
+                      << intensity << std::setw(10) << roof * 1e-9 << std::setw(6)
+                      << (int)(100 * ops / time / roof + 0.5) << "%" << std::setw(9) << bound << std::setw(10);
+            if (naive) std::cout << naive_time / time << "x";
+            else std::cout << "- ";
+            std::cout << (errors ? "  WRONG (" + std::to_string(errors) + " elements)" : "") << std::endl;
+            if (csv) {
+                *csv << type << ',' << kernel.name << ',' << s.m << ',' << s.k << ',' << s.n << ',' << threads << ','
+                     << time << ',' << ops / time * 1e-9 << ',' << bytes / time * 1e-9 << ',' << intensity << ','
+                     << peak[t] * 1e-9 << ',' << bandwidth * 1e-9 << ',' << roof * 1e-9 << ',' << bound << ','
+                     << naive_time << ',' << errors << '\n';
             }
         }
-        if (!correct) break;
     }
+}
 
-    std::cout << "\nVerification: Results are " << (correct ? "identical." : "DIFFERENT - there might be an error!") << std::endl;
+// "a,b,c" -> {"a", "b", "c"}
+std::vector<std::string> split(const std::string& list, char separator) {
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, separator)) items.push_back(item);
+    return items;
+}
 
-    // Print a small portion of the results for visual inspection
-    std::cout << "\nPartial Sequential Result (top-left 5x5):" << std::endl;
-    printMatrixPartial(matrixC_sequential, ROWS_A, COLS_B);
+// "N" or "MxKxN"
+bool parse_shape(const std::string& text, Shape& s) {
+    std::vector<std::string> dims = split(text, 'x');
+    if (dims.size() != 1 && dims.size() != 3) return false;
+    std::vector<std::size_t> v;
+    for (const std::string& d : dims) {
+        long x = std::atol(d.c_str());
+        if (x <= 0) return false;
+        v.push_back((std::size_t)x);
+    }
+    s = dims.size() == 1 ? Shape{v[0], v[0], v[0]} : Shape{v[0], v[1], v[2]};
+    return true;
+}
 
-    std::cout << "\nPartial Parallel Result (top-left 5x5):" << std::endl;
-    printMatrixPartial(matrixC_parallel, ROWS_A, COLS_B);
+int main(int argc, char** argv) {
+    Options opt;
+    opt.types = {"double"};
+    opt.threads = {1};
+    if (omp_get_max_threads() > 1) opt.threads.push_back(omp_get_max_threads());
+    opt.reps = 3;
+    opt.naive_max = 512;
+    std::size_t min_n = 0, max_n = 0;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        std::string arg = argv[i];
+        Shape s;
+        if (arg == "-s" && i + 1 < argc && parse_shape(argv[i + 1], s)) {
+            opt.shapes.push_back(s);
+            ++i;
+        }
+        else if (arg == "--min" && i + 1 < argc) min_n = std::atol(argv[++i]);
+        else if (arg == "--max" && i + 1 < argc) max_n = std::atol(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc) opt.types = split(argv[++i], ',');
+        else if (arg == "-t" && i + 1 < argc) {
+            opt.threads.clear();
+            for (const std::string& t : split(argv[++i], ',')) opt.threads.push_back(std::atoi(t.c_str()));
+        }
+        else if (arg == "-r" && i + 1 < argc) opt.reps = std::atoi(argv[++i]);
+        else if (arg == "--naive-max" && i + 1 < argc) opt.naive_max = std::atol(argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc) opt.csv = argv[++i];
+        else usage = true;
+    }
+    for (int t : opt.threads) usage |= t < 1;
+    for (const std::string& type : opt.types) {
+        usage |= type != "double" && type != "float" && type != "int32" && type != "int8";
+    }
+    if (usage || opt.reps < 1 || opt.threads.empty() || (min_n == 0) != (max_n == 0)) {
+        std::cerr << "Usage: " << argv[0] << " [-s N|MxKxN ...] [--min n --max n] [-p double,float,int32,int8]"
+                  << " [-t threads,...] [-r reps] [--naive-max n] [--csv file]" << std::endl;
+        return 1;
+    }
+    for (std::size_t n = min_n; n && n <= max_n; n *= 2) opt.shapes.push_back(Shape{n, n, n});
+    if (opt.shapes.empty()) opt.shapes.push_back(Shape{500, 500, 500});
 
-    // --- Performance Analysis ---
-    if (duration_parallel.count() > 0) {
-        double speedup = duration_sequential.count() / duration_parallel.count();
-        std::cout << "\n--- Performance Summary ---" << std::endl;
-        std::cout << "Sequential Time: " << duration_sequential.count() << " seconds" << std::endl;
-        std::cout << "Parallel Time:   " << duration_parallel.count() << " seconds" << std::endl;
-        std::cout << "Speedup: " << speedup << "x" << std::endl;
-        std::cout << "Number of threads used (runtime): " << omp_get_max_threads() << std::endl;
-        std::cout << "Note: Speedup depends on CPU cores, overheads, and matrix size." << std::endl;
+    std::ofstream csv;
+    if (!opt.csv.empty()) {
+        bool fresh = !std::ifstream(opt.csv.c_str()).good();
+        csv.open(opt.csv.c_str(), std::ios::app);
+        if (!csv) {
+            std::cerr << "cannot write " << opt.csv << std::endl;
+            return 1;
+        }
+        if (fresh) {
+            csv << "type,kernel,m,k,n,threads,best_s,gflops,gbytes_s,intensity,peak_gflops,stream_gbytes_s,"
+                   "roof_gflops,bound,naive_s,errors\n";
+        }
     }
 
+    std::cout << "STREAM triad:";
+    for (int t : opt.threads) std::cout << " " << stream_bandwidth(t) * 1e-9 << " GB/s (" << t << " thr)";
+    std::cout << std::endl;
+    std::cout << std::setw(7) << "type" << std::setw(11) << "kernel" << std::setw(17) << "m x k x n" << std::setw(4)
+              << "thr" << std::setw(12) << "best (s)" << std::setw(10) << "GFLOP/s" << std::setw(8) << "GB/s"
+              << std::setw(8) << "op/B" << std::setw(10) << "roof" << std::setw(7) << "%roof" << std::setw(9)
+              << "bound" << std::setw(11) << "vs naive" << std::endl;
+    for (const std::string& type : opt.types) {
+        std::ostream* out = csv.is_open() ? &csv : nullptr;
+        if (type == "double") run<double, double>("double", opt, out);
+        else if (type == "float") run<float, float>("float", opt, out);
+        else if (type == "int32") run<std::int32_t, std::int32_t>("int32", opt, out);
+        else run<std::int32_t, std::int8_t>("int8", opt, out);
+    }
     return 0;
 }
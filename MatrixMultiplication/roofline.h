@@ -0,0 +1,190 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "gemm.h"
+
+// Machine ceilings for a roofline report: the peak multiply-add rate of the
+// instructions a GEMM kernel is built from, and the STREAM triad bandwidth.
+//
+// Peak: each thread runs ROOFLINE_CHAINS independent multiply-add chains on
+// registers only (enough to cover the latency of the pipelined units), with
+// the vector width and instructions of the kernel's ISA, as named by
+// gemm_kernel<T, In>().name:
+//   double, float, int32   acc = acc * x + y   (vfmadd, or vpmulld + vpaddd)
+//   int8 avx512vnni        vpdpbusd, 64 multiply-adds per instruction
+//   int8 avx2              vpmaddwd + vpaddd, 16 per pair (the int8 kernel
+//                          widens to int16 first)
+//   portable               16-byte vectors of T (int32 for int8 inputs)
+// A multiply-add counts as 2 operations, as in the GEMM flop count 2 m n k.
+//
+// Bandwidth: a[i] = b[i] + s * c[i] over three arrays far larger than the
+// caches, counted as 24 bytes per element like STREAM (the write-allocate
+// read of a is not counted).
+
+// Independent multiply-add chains in the peak loop
+const int ROOFLINE_CHAINS = 12;
+// Iterations of the peak loop per thread (about 50 ms at a few GHz)
+const long ROOFLINE_ITERATIONS = 10000000;
+// Elements per STREAM array (3 arrays of 64 MB)
+const std::size_t ROOFLINE_STREAM_SIZE = std::size_t(1) << 23;
+
+// x = 1 and y = 1 read through a volatile so the compiler cannot fold them
+static volatile int roofline_one = 1;
+
+// The chains on vectors of Bytes bytes; returns one lane to keep the result live.
+// always_inline so the vector code is compiled for the ISA of the caller.
+template <typename T, int Bytes>
+__attribute__((always_inline)) inline T roofline_madd_vector(long iterations) {
+    typedef T Vec __attribute__((vector_size(Bytes)));
+    const T step = std::is_integral<T>::value ? T(1) : T(1) / T(1 << 20);
+    Vec x, y, acc[ROOFLINE_CHAINS];
+    for (int i = 0; i < Bytes / (int)sizeof(T); ++i) {
+        x[i] = T(roofline_one);
+        y[i] = T(roofline_one) * step;
+    }
+#pragma GCC unroll 16
+    for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = y * T(i + 1);  // distinct, or the chains get merged
+    for (long r = 0; r < iterations; ++r) {
+#pragma GCC unroll 16
+        for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = acc[i] * x + y;
+    }
+    for (int i = 1; i < ROOFLINE_CHAINS; ++i) acc[0] += acc[i];
+    return acc[0][0];
+}
+
+template <typename T>
+inline T roofline_madd_portable(long iterations) {
+    return roofline_madd_vector<T, 16>(iterations);
+}
+
+#ifdef GEMM_X86
+template <typename T>
+__attribute__((target("avx2,fma"))) inline T roofline_madd_avx2(long iterations) {
+    return roofline_madd_vector<T, 32>(iterations);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) inline T roofline_madd_avx512(long iterations) {
+    return roofline_madd_vector<T, 64>(iterations);
+}
+
+__attribute__((target("avx2"))) inline std::int32_t roofline_madd_avx2_i16(long iterations) {
+    __m256i x = _mm256_set1_epi16((short)roofline_one), y = _mm256_set1_epi32(roofline_one);
+    __m256i acc[ROOFLINE_CHAINS];
+#pragma GCC unroll 16
+    for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = _mm256_set1_epi32(i);
+    for (long r = 0; r < iterations; ++r) {
+#pragma GCC unroll 16
+        for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = _mm256_add_epi32(_mm256_madd_epi16(acc[i], x), y);
+    }
+    for (int i = 1; i < ROOFLINE_CHAINS; ++i) acc[0] = _mm256_add_epi32(acc[0], acc[i]);
+    return _mm256_extract_epi32(acc[0], 0);
+}
+
+__attribute__((target("avx512f,avx512vnni"))) inline std::int32_t roofline_madd_avx512vnni_i8(long iterations) {
+    __m512i x = _mm512_set1_epi8((char)roofline_one), y = _mm512_set1_epi8((char)roofline_one);
+    __m512i acc[ROOFLINE_CHAINS];
+#pragma GCC unroll 16
+    for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = _mm512_set1_epi32(i);
+    for (long r = 0; r < iterations; ++r) {
+#pragma GCC unroll 16
+        for (int i = 0; i < ROOFLINE_CHAINS; ++i) acc[i] = _mm512_dpbusd_epi32(acc[i], x, y);
+    }
+    for (int i = 1; i < ROOFLINE_CHAINS; ++i) acc[0] = _mm512_add_epi32(acc[0], acc[i]);
+    std::int32_t lanes[16];
+    _mm512_storeu_si512(lanes, acc[0]);
+    return lanes[0];
+}
+#endif
+
+// Multiply-adds per instruction (per chain and iteration) and the loop itself
+struct RooflineLoop {
+    double madds;
+    double (*run)(long iterations);
+};
+
+template <typename R, R (*Run)(long)>
+inline double roofline_run(long iterations) {
+    return (double)Run(iterations);
+}
+
+// The loop for the ISA `isa` (a GemmKernel name), C of type T and A, B of type In
+template <typename T, typename In>
+inline RooflineLoop roofline_loop(const char* isa) {
+#ifdef GEMM_X86
+    if (sizeof(In) == 1 && !std::strcmp(isa, "avx512vnni")) {
+        RooflineLoop loop = { 64, roofline_run<std::int32_t, roofline_madd_avx512vnni_i8> };
+        return loop;
+    }
+    if (sizeof(In) == 1 && !std::strcmp(isa, "avx2")) {
+        RooflineLoop loop = { 16, roofline_run<std::int32_t, roofline_madd_avx2_i16> };
+        return loop;
+    }
+    if (!std::strcmp(isa, "avx512")) {
+        RooflineLoop loop = { 64.0 / sizeof(T), roofline_run<T, roofline_madd_avx512<T> > };
+        return loop;
+    }
+    if (!std::strcmp(isa, "avx2")) {
+        RooflineLoop loop = { 32.0 / sizeof(T), roofline_run<T, roofline_madd_avx2<T> > };
+        return loop;
+    }
+#endif
+    RooflineLoop loop = { 16.0 / sizeof(T), roofline_run<T, roofline_madd_portable<T> > };
+    return loop;
+}
+
+// Peak operations per second (2 per multiply-add) of `threads` threads running
+// the instructions of the `isa` kernel for C of type T and A, B of type In
+template <typename T, typename In = T>
+inline double measure_peak_ops(const char* isa, int threads = 1, int reps = 5) {
+    if (threads < 1) throw std::invalid_argument("measure_peak_ops: threads must be positive");
+    RooflineLoop loop = roofline_loop<T, In>(isa);
+    double best = 1e30, sink = 0;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+#pragma omp parallel num_threads(threads) if(threads > 1) reduction(+ : sink)
+        sink += loop.run(ROOFLINE_ITERATIONS);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    roofline_one = sink != 0;  // keeps the chains' results live
+    return 2.0 * loop.madds * ROOFLINE_CHAINS * ROOFLINE_ITERATIONS * threads / best;
+}
+
+// STREAM triad bandwidth in bytes per second with `threads` threads, best of `reps`
+inline double measure_stream_bandwidth(int threads = 1, int reps = 5, std::size_t n = ROOFLINE_STREAM_SIZE) {
+    if (threads < 1) throw std::invalid_argument("measure_stream_bandwidth: threads must be positive");
+    GemmBuffer<double> a(n), b(n), c(n);
+    long count = (long)n;
+    // First touch by the threads that will stream each part
+#pragma omp parallel for num_threads(threads) if(threads > 1) schedule(static)
+    for (long i = 0; i < count; ++i) {
+        a.data()[i] = 0;
+        b.data()[i] = 1;
+        c.data()[i] = 2;
+    }
+    double best = 1e30;
+    const double s = 3;
+    for (int r = 0; r < reps; ++r) {
+        double* pa = a.data();
+        const double* pb = b.data();
+        const double* pc = c.data();
+        auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for num_threads(threads) if(threads > 1) schedule(static)
+        for (long i = 0; i < count; ++i) pa[i] = pb[i] + s * pc[i];
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (a.data()[n / 2] != 7) throw std::runtime_error("measure_stream_bandwidth: wrong triad result");
+    return 3.0 * sizeof(double) * n / best;
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include "matrix.h"
+#include "gemm.h"
+
+// Strassen-Winograd matrix multiply, C = A * B, on top of the blocked gemm().
+//
+// One level splits A, B and C into 2 x 2 blocks and forms the product from 7
+// block products instead of 8, at the price of 15 block additions:
+//
+//   S1 = A21 + A22   T1 = B12 - B11   P1 = A11 B11   P5 = S1 T1   C11 = P1 + P2
+//   S2 = S1 - A11    T2 = B22 - T1    P2 = A12 B21   P6 = S2 T2   C12 = U2 + P5 + P3
+//   S3 = A11 - A21   T3 = B22 - B12   P3 = S4 B22    P7 = S3 T3   C21 = U2 + P7 - P4
+//   S4 = A12 - S2    T4 = T2 - B21    P4 = A22 T4    U2 = P1 + P6 C22 = U2 + P7 + P5
+//
+// The products recurse until a dimension drops below the crossover, where
+// gemm() is faster than another level; odd dimensions are handled by peeling
+// off the last row / column / k slice with gemm(). Each level saves 1/8 of
+// the flops, but the additions stream memory, so the crossover is large and
+// machine dependent: tune_strassen_crossover() measures it.
+//
+// Workspace comes from one arena allocated by the plan, carved up level by
+// level. Sequential levels use the two-temporary schedule of Boyer, Dumas,
+// Pernet and Zhou ("Memory efficient scheduling of Strassen-Winograd's matrix
+// multiplication algorithm", 2009), which builds most products directly in
+// the quadrants of C: about 2/3 n^2 extra elements in total for n x n. With
+// threads > 1 the top level (two levels for more than 7 threads) instead keeps
+// all S, T and three of the P blocks live so the seven products can run as
+// concurrent OpenMP tasks, each on its own slice of the arena; the additions
+// there are split across threads with taskloop. Below the task levels every
+// gemm() runs on one thread.
+//
+// Strassen is less accurate than the classic product: the error bound grows
+// by roughly a factor of 3-4 per level (and with the norms of A and B, not
+// of the individual products), so the bench reports both errors.
+
+// Default crossover (on min(m, n, k)), measured on one AVX-512 core; override
+// with the STRASSEN_CROSSOVER environment variable or a plan argument
+const std::size_t STRASSEN_CROSSOVER = 2048;
+
+inline std::size_t strassen_crossover() {
+    const char* env = std::getenv("STRASSEN_CROSSOVER");
+    long x = env ? std::atol(env) : 0;
+    return x > 0 ? (std::size_t)x : STRASSEN_CROSSOVER;
+}
+
+template <typename T>
+class StrassenPlan {
+public:
+    // crossover = 0 uses strassen_crossover()
+    StrassenPlan(std::size_t m, std::size_t n, std::size_t k, int threads = 1, std::size_t crossover = 0)
+        : m_(m), n_(n), k_(k), threads_(std::max(threads, 1)), crossover_(crossover ? crossover : strassen_crossover()),
+          task_depth_(threads_ == 1 ? 0 : threads_ <= 7 ? 1 : 2), levels_(count_levels(m, n, k)),
+          workspace_(workspace(m, n, k, 0)), arena_(workspace_) {}
+
+    std::size_t levels() const { return levels_; }
+    std::size_t crossover() const { return crossover_; }
+    std::size_t workspace_bytes() const { return workspace_ * sizeof(T); }
+
+    // C = A * B; A is m x k, B k x n, C m x n, any layouts
+    void execute(MatrixView<const T> A, MatrixView<const T> B, MatrixView<T> C) {
+        if (A.rows() != m_ || A.cols() != k_ || B.rows() != k_ || B.cols() != n_ || C.rows() != m_ || C.cols() != n_) {
+            throw std::invalid_argument("StrassenPlan::execute: shapes do not match the plan");
+        }
+        // Temporaries and the fast additions are row-major: compute a column-major C as C^T = B^T A^T
+        if (C.layout() == COL_MAJOR) {
+            StrassenPlan t(n_, m_, k_, threads_, crossover_);
+            t.execute(B.transposed(), A.transposed(), C.transposed());
+            return;
+        }
+        if (levels_ == 0 || task_depth_ == 0) {
+            recurse(A, B, C, 0, arena_.data());
+            return;
+        }
+        #pragma omp parallel num_threads(threads_)
+        {
+            #pragma omp single
+            recurse(A, B, C, 0, arena_.data());
+        }
+    }
+
+private:
+    bool leaf(std::size_t m, std::size_t n, std::size_t k) const {
+        return std::min(m, std::min(n, k)) < std::max(crossover_, (std::size_t)2);
+    }
+
+    std::size_t count_levels(std::size_t m, std::size_t n, std::size_t k) const {
+        std::size_t l = 0;
+        for (; !leaf(m, n, k); m /= 2, n /= 2, k /= 2) ++l;
+        return l;
+    }
+
+    // Arena elements needed from this level down
+    std::size_t workspace(std::size_t m, std::size_t n, std::size_t k, int depth) const {
+        if (leaf(m, n, k)) return 0;
+        std::size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+        std::size_t child = workspace(m2, n2, k2, depth + 1);
+        if (depth < task_depth_) return 4 * m2 * k2 + 4 * k2 * n2 + 3 * m2 * n2 + 7 * child;
+        return std::max(m2 * k2, m2 * n2) + k2 * n2 + child;
+    }
+
+    // Z = X + Y or X - Y, element by element (Z may be X or Y); rows split into tasks if parallel
+    static void add(MatrixView<const T> X, MatrixView<const T> Y, bool subtract, MatrixView<T> Z, bool parallel) {
+        long rows = (long)Z.rows();
+        std::size_t cols = Z.cols();
+        bool unit = X.col_stride() == 1 && Y.col_stride() == 1 && Z.col_stride() == 1;
+        auto row = [&](long i) {
+            if (unit) {
+                const T* x = &X(i, 0);
+                const T* y = &Y(i, 0);
+                T* z = &Z(i, 0);
+                if (subtract) {
+                    for (std::size_t j = 0; j < cols; ++j) z[j] = x[j] - y[j];
+                } else {
+                    for (std::size_t j = 0; j < cols; ++j) z[j] = x[j] + y[j];
+                }
+            } else {
+                for (std::size_t j = 0; j < cols; ++j) Z(i, j) = subtract ? X(i, j) - Y(i, j) : X(i, j) + Y(i, j);
+            }
+        };
+        if (parallel) {
+            #pragma omp taskloop grainsize(16)
+            for (long i = 0; i < rows; ++i) row(i);
+        } else {
+            for (long i = 0; i < rows; ++i) row(i);
+        }
+    }
+
+    void recurse(MatrixView<const T> A, MatrixView<const T> B, MatrixView<T> C, int depth, T* ws) {
+        std::size_t m = C.rows(), n = C.cols(), k = A.cols();
+        if (leaf(m, n, k)) {
+            // Inside the tasks of an upper level each product gets one thread
+            gemm<T>(T(1), A, B, T(0), C, depth > 0 && task_depth_ > 0 ? 1 : threads_);
+            return;
+        }
+        std::size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+        MatrixView<const T> A11 = A.block(0, 0, m2, k2), A12 = A.block(0, k2, m2, k2);
+        MatrixView<const T> A21 = A.block(m2, 0, m2, k2), A22 = A.block(m2, k2, m2, k2);
+        MatrixView<const T> B11 = B.block(0, 0, k2, n2), B12 = B.block(0, n2, k2, n2);
+        MatrixView<const T> B21 = B.block(k2, 0, k2, n2), B22 = B.block(k2, n2, k2, n2);
+        MatrixView<T> C11 = C.block(0, 0, m2, n2), C12 = C.block(0, n2, m2, n2);
+        MatrixView<T> C21 = C.block(m2, 0, m2, n2), C22 = C.block(m2, n2, m2, n2);
+
+        if (depth < task_depth_) {
+            winograd_tasks(A11, A12, A21, A22, B11, B12, B21, B22, C11, C12, C21, C22, depth, ws);
+        } else {
+            winograd(A11, A12, A21, A22, B11, B12, B21, B22, C11, C12, C21, C22, depth, ws);
+        }
+
+        // Odd dimensions: the k slice, column and row left out of the 2 x 2 split
+        std::size_t me = 2 * m2, ne = 2 * n2, ke = 2 * k2;
+        if (k > ke) gemm<T>(T(1), A.block(0, ke, me, 1), B.block(ke, 0, 1, ne), T(1), C.block(0, 0, me, ne), 1);
+        if (n > ne) gemm<T>(T(1), A, B.block(0, ne, k, 1), T(0), C.block(0, ne, m, 1), 1);
+        if (m > me) gemm<T>(T(1), A.block(me, 0, 1, k), B.block(0, 0, k, ne), T(0), C.block(me, 0, 1, ne), 1);
+    }
+
+    // Sequential level: temporaries X (S blocks, then P1) and Y (T blocks); the
+    // other products are formed in the quadrants of C
+    void winograd(MatrixView<const T> A11, MatrixView<const T> A12, MatrixView<const T> A21, MatrixView<const T> A22,
+                  MatrixView<const T> B11, MatrixView<const T> B12, MatrixView<const T> B21, MatrixView<const T> B22,
+                  MatrixView<T> C11, MatrixView<T> C12, MatrixView<T> C21, MatrixView<T> C22, int depth, T* ws) {
+        std::size_t m2 = C11.rows(), n2 = C11.cols(), k2 = A11.cols();
+        MatrixView<T> X(ws, m2, k2), Y(ws + std::max(m2 * k2, m2 * n2), k2, n2);
+        MatrixView<T> P1(ws, m2, n2);
+        T* child = ws + std::max(m2 * k2, m2 * n2) + k2 * n2;
+
+        add(A11, A21, true, X, false);                  // S3
+        add(B22, B12, true, Y, false);                  // T3
+        recurse(X, Y, C21, depth + 1, child);           // P7 = S3 T3
+        add(A21, A22, false, X, false);                 // S1
+        add(B12, B11, true, Y, false);                  // T1
+        recurse(X, Y, C22, depth + 1, child);           // P5 = S1 T1
+        add(X, A11, true, X, false);                    // S2 = S1 - A11
+        add(B22, Y, true, Y, false);                    // T2 = B22 - T1
+        recurse(X, Y, C12, depth + 1, child);           // P6 = S2 T2
+        add(A12, X, true, X, false);                    // S4 = A12 - S2
+        recurse(X, B22, C11, depth + 1, child);         // P3 = S4 B22
+        recurse(A11, B11, P1, depth + 1, child);        // P1, over S4
+        add(P1, C12, false, C12, false);                // U2 = P1 + P6
+        add(C12, C21, false, C21, false);               // U3 = U2 + P7
+        add(C12, C22, false, C12, false);               // U4 = U2 + P5
+        add(C21, C22, false, C22, false);               // C22 = U3 + P5
+        add(C12, C11, false, C12, false);               // C12 = U4 + P3
+        add(Y, B21, true, Y, false);                    // T4 = T2 - B21
+        recurse(A22, Y, C11, depth + 1, child);         // P4 = A22 T4
+        add(C21, C11, true, C21, false);                // C21 = U3 - P4
+        recurse(A12, B21, C11, depth + 1, child);       // P2
+        add(P1, C11, false, C11, false);                // C11 = P1 + P2
+    }
+
+    // Task level: all operands of the seven products live at once, products as tasks
+    void winograd_tasks(MatrixView<const T> A11, MatrixView<const T> A12, MatrixView<const T> A21,
+                        MatrixView<const T> A22, MatrixView<const T> B11, MatrixView<const T> B12,
+                        MatrixView<const T> B21, MatrixView<const T> B22, MatrixView<T> C11, MatrixView<T> C12,
+                        MatrixView<T> C21, MatrixView<T> C22, int depth, T* ws) {
+        std::size_t m2 = C11.rows(), n2 = C11.cols(), k2 = A11.cols();
+        MatrixView<T> S[4], Tb[4];
+        for (int i = 0; i < 4; ++i, ws += m2 * k2) S[i] = MatrixView<T>(ws, m2, k2);
+        for (int i = 0; i < 4; ++i, ws += k2 * n2) Tb[i] = MatrixView<T>(ws, k2, n2);
+        MatrixView<T> P1(ws, m2, n2), P6(ws + m2 * n2, m2, n2), P7(ws + 2 * m2 * n2, m2, n2);
+        ws += 3 * m2 * n2;
+        std::size_t child = workspace(m2, n2, k2, depth + 1);
+
+        add(A21, A22, false, S[0], true);
+        add(S[0], A11, true, S[1], true);
+        add(A11, A21, true, S[2], true);
+        add(A12, S[1], true, S[3], true);
+        add(B12, B11, true, Tb[0], true);
+        add(B22, Tb[0], true, Tb[1], true);
+        add(B22, B12, true, Tb[2], true);
+        add(Tb[1], B21, true, Tb[3], true);
+
+        // P2 .. P5 go straight into C11, C12, C21, C22
+        #pragma omp task
+        recurse(A11, B11, P1, depth + 1, ws);
+        #pragma omp task
+        recurse(A12, B21, C11, depth + 1, ws + child);
+        #pragma omp task
+        recurse(S[3], B22, C12, depth + 1, ws + 2 * child);
+        #pragma omp task
+        recurse(A22, Tb[3], C21, depth + 1, ws + 3 * child);
+        #pragma omp task
+        recurse(S[0], Tb[0], C22, depth + 1, ws + 4 * child);
+        #pragma omp task
+        recurse(S[1], Tb[1], P6, depth + 1, ws + 5 * child);
+        #pragma omp task
+        recurse(S[2], Tb[2], P7, depth + 1, ws + 6 * child);
+        #pragma omp taskwait
+
+        add(P6, P1, false, P6, true);     // U2
+        add(P7, P6, false, P7, true);     // U3 = U2 + P7
+        add(C12, P6, false, C12, true);   // P3 + U2
+        add(C12, C22, false, C12, true);  // C12 = P3 + U2 + P5
+        add(P7, C22, false, C22, true);   // C22 = U3 + P5
+        add(P7, C21, true, C21, true);    // C21 = U3 - P4
+        add(C11, P1, false, C11, true);   // C11 = P2 + P1
+    }
+
+    std::size_t m_, n_, k_;
+    int threads_;
+    std::size_t crossover_;
+    int task_depth_;
+    std::size_t levels_, workspace_;
+    GemmBuffer<T> arena_;
+};
+
+// C = A * B with Strassen-Winograd; builds a plan (and its arena) per call
+template <typename T>
+inline void strassen(MatrixView<const T> A, MatrixView<const T> B, MatrixView<T> C, int threads = 1,
+                     std::size_t crossover = 0) {
+    StrassenPlan<T>(C.rows(), C.cols(), A.cols(), threads, crossover).execute(A, B, C);
+}
+
+// Smallest n (doubling from `from` up to `to`) from which one Strassen level
+// over n x n beats gemm() of the same size at every larger size too, timed best
+// of `reps` after a warm-up run; 2 * to if even `to` loses. Requiring the win to
+// persist keeps one noisy small size from enabling many levels.
+template <typename T>
+inline std::size_t tune_strassen_crossover(int threads = 1, std::size_t from = 256, std::size_t to = 4096,
+                                           int reps = 3) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> u(-1, 1);
+    std::size_t crossover = 2 * to;
+    for (std::size_t n = from; n <= to; n *= 2) {
+        Matrix<T> A(n, n), B(n, n), C(n, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                A(i, j) = (T)u(rng);
+                B(i, j) = (T)u(rng);
+            }
+        }
+        StrassenPlan<T> plan(n, n, n, threads, n);
+        auto best = [&](bool fast) {
+            double t = 1e30;
+            for (int r = 0; r <= reps; ++r) {
+                auto start = std::chrono::steady_clock::now();
+                if (fast) plan.execute(A, B, C);
+                else gemm(A, B, C, threads);
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (r > 0) t = std::min(t, elapsed);
+            }
+            return t;
+        };
+        if (best(true) < best(false)) crossover = std::min(crossover, n);
+        else crossover = 2 * to;
+    }
+    return crossover;
+}
+
+#endif
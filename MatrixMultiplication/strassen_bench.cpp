@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "matrix.h"
+#include "gemm.h"
+#include "strassen.h"
+
+using namespace std;
+
+// Strassen-Winograd against the classic blocked gemm() on n x n products.
+// Error is the relative residual ||C x - A (B x)|| / ||A (B x)|| for a random
+// x, with A (B x) in long double: O(n^2), so it is reported at every size.
+// Usage: ./strassen_bench [-t threads] [-p float|double] [-x crossover|tune]
+//                         [--min 1024] [--max 4096] [--reps 3]
+template <typename T>
+double residual(const Matrix<T>& A, const Matrix<T>& B, const Matrix<T>& C, const vector<long double>& x) {
+    size_t n = A.rows();
+    vector<long double> y(n, 0), z(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) y[i] += (long double)B(i, j) * x[j];
+    }
+    long double err = 0, ref = 0;
+    for (size_t i = 0; i < n; ++i) {
+        long double w = 0;
+        for (size_t j = 0; j < n; ++j) {
+            z[i] += (long double)A(i, j) * y[j];
+            w += (long double)C(i, j) * x[j];
+        }
+        err += (w - z[i]) * (w - z[i]);
+        ref += z[i] * z[i];
+    }
+    return (double)sqrtl(err / ref);
+}
+
+double best_time(int reps, const function<void()>& f) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto start = chrono::steady_clock::now();
+        f();
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+template <typename T>
+void run(int threads, size_t crossover, size_t min_n, size_t max_n, int reps) {
+    if (crossover == 0) {
+        cout << "Tuning the crossover ..." << flush;
+        crossover = tune_strassen_crossover<T>(threads, 256, max_n);
+        cout << " " << crossover << endl;
+    }
+    cout << "kernel " << gemm_kernel<T>().name << ", " << threads << " thread(s), crossover " << crossover << endl;
+    cout << setw(7) << "n" << setw(8) << "levels" << setw(12) << "gemm (s)" << setw(13) << "Strassen (s)"
+         << setw(9) << "speedup" << setw(11) << "GFLOP/s" << setw(14) << "gemm error" << setw(16) << "Strassen error"
+         << setw(11) << "work (MB)" << endl;
+
+    mt19937 rng(11);
+    uniform_real_distribution<double> u(-1, 1);
+    for (size_t n = min_n; n <= max_n; n *= 2) {
+        Matrix<T> A(n, n), B(n, n), C(n, n), S(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                A(i, j) = (T)u(rng);
+                B(i, j) = (T)u(rng);
+            }
+        }
+        vector<long double> x(n);
+        for (size_t i = 0; i < n; ++i) x[i] = u(rng);
+
+        StrassenPlan<T> plan(n, n, n, threads, crossover);
+        double t_gemm = best_time(reps, [&] { gemm(A, B, C, threads); });
+        double t_fast = best_time(reps, [&] { plan.execute(A, B, S); });
+        // Effective rate: classic flop count over time, so the two columns compare directly
+        cout << setw(7) << n << setw(8) << plan.levels() << setw(12) << t_gemm << setw(13) << t_fast
+             << setw(9) << t_gemm / t_fast << setw(11) << 2.0 * n * n * n / t_fast * 1e-9
+             << setw(14) << residual(A, B, C, x) << setw(16) << residual(A, B, S, x)
+             << setw(11) << (plan.workspace_bytes() >> 20) << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    int threads = 1, reps = 3;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    size_t crossover = strassen_crossover(), min_n = 1024, max_n = 4096;
+    string precision = "double";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc) precision = argv[++i];
+        else if (arg == "-x" && i + 1 < argc) {
+            string x = argv[++i];
+            crossover = x == "tune" ? 0 : atol(x.c_str());
+        }
+        else if (arg == "--min" && i + 1 < argc) min_n = atol(argv[++i]);
+        else if (arg == "--max" && i + 1 < argc) max_n = atol(argv[++i]);
+        else if (arg == "--reps" && i + 1 < argc) reps = atoi(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [-t threads] [-p float|double] [-x crossover|tune]"
+                 << " [--min n] [--max n] [--reps r]" << endl;
+            return 1;
+        }
+    }
+
+    if (precision == "float") run<float>(threads, crossover, min_n, max_n, reps);
+    else if (precision == "double") run<double>(threads, crossover, min_n, max_n, reps);
+    else {
+        cerr << "precision must be float or double" << endl;
+        return 1;
+    }
+    return 0;
+}